@@ -0,0 +1,628 @@
+#define _GNU_SOURCE
+#define TRAIN_SERVER_NO_MAIN
+#include "../server.c"
+#include "trainclient.h"
+
+#include <sys/socket.h>
+#include <sys/stat.h>
+#include <stdatomic.h>
+#include <getopt.h>
+
+#define BENCH_CLIENTS 4
+#define PIPELINE_DEPTH 256
+#define MAX_SIZES 8
+
+static FILE *out;
+static const char *tag = "unknown";
+
+static long long now_ns(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (long long)ts.tv_sec * 1000000000LL + ts.tv_nsec;
+}
+
+//o linie JSON per benchmark, ca sa se poata compara intre commit-uri
+static void record(const char *name, int n, long ops, long long ns) {
+    double per_op = ops > 0 ? (double)ns / ops : 0.0;
+    double per_sec = ns > 0 ? ops * 1e9 / ns : 0.0;
+
+    fprintf(out, "{\"tag\":\"%s\",\"bench\":\"%s\",\"trains\":%d,\"ops\":%ld,"
+                 "\"total_ns\":%lld,\"ns_per_op\":%.1f,\"ops_per_sec\":%.1f}\n",
+            tag, name, n, ops, ns, per_op, per_sec);
+    fflush(out);
+    fprintf(stderr, "%-22s trains=%-8d ops=%-8ld %12.1f ns/op %12.1f ops/s\n",
+           name, n, ops, per_op, per_sec);
+}
+
+//ca record(), dar ops numara doar raspunsurile reale; cererile refuzate (busy) sau
+//pierdute sunt raportate separat, ca mai multa aruncare sa nu para o accelerare
+static void record_shed(const char *name, int n, long ops, long busy, long lost, long long ns) {
+    double per_op = ops > 0 ? (double)ns / ops : 0.0;
+    double per_sec = ns > 0 ? ops * 1e9 / ns : 0.0;
+
+    fprintf(out, "{\"tag\":\"%s\",\"bench\":\"%s\",\"trains\":%d,\"ops\":%ld,"
+                 "\"total_ns\":%lld,\"ns_per_op\":%.1f,\"ops_per_sec\":%.1f,"
+                 "\"busy\":%ld,\"lost\":%ld}\n",
+            tag, name, n, ops, ns, per_op, per_sec, busy, lost);
+    fflush(out);
+    fprintf(stderr, "%-22s trains=%-8d ops=%-8ld %12.1f ns/op %12.1f ops/s  busy=%ld lost=%ld\n",
+           name, n, ops, per_op, per_sec, busy, lost);
+}
+
+//mai multe iteratii pentru flote mici, ca timpul total sa fie comparabil
+static long iters_for(int n, long budget, long lo, long hi) {
+    long it = budget / n;
+    if (it < lo) it = lo;
+    if (it > hi) it = hi;
+    return it;
+}
+
+//flota sintetica: ore raspandite pe toata ziua, cateva intarzieri si anulari
+static void make_trains(int n) {
+    pthread_mutex_lock(&train_mutex);
+    if (n > trainCapacity) {
+        trainCapacity = n;
+        trains = realloc(trains, (size_t)trainCapacity * sizeof(Train));
+    }
+    trainCount = n;
+    for (int i = 0; i < n; i++) {
+        Train *t = &trains[i];
+        int dep = (i * 7) % 1440;
+        int arr = (dep + 30 + i % 240) % 1440;
+
+        snprintf(t->id, sizeof(t->id), "T%07d", i);
+        t->dep_h = dep / 60; t->dep_m = dep % 60;
+        t->arr_h = arr / 60; t->arr_m = arr % 60;
+        if (i % 50 == 0) t->delay = -999;
+        else if (i % 5 == 0) t->delay = i % 45;
+        else if (i % 17 == 0) t->delay = -(i % 4);
+        else t->delay = 0;
+        strcpy(t->features, "Economy Class | Bike Racks");
+        strcpy(t->route, "Iasi -> Brasov");
+        if (t->delay == -999) strcpy(t->eta, "--:--");
+        else computeETA(t);
+    }
+    pthread_mutex_unlock(&train_mutex);
+}
+
+//raspunsul de suprasarcina asa cum apare pe fir (fara tag); completat in main()
+static char busy_frame[64];
+
+//numara raspunsurile (MSG_END) si, separat, pe cele "Server busy" dintr-un flux
+typedef struct { size_t k, bk; } FrameScan;
+
+static void scan_frames(FrameScan *fs, const char *buf, ssize_t n, long *frames, long *busy) {
+    const char *pat = MSG_END;
+    size_t plen = strlen(pat), blen = strlen(busy_frame);
+
+    for (ssize_t i = 0; i < n; i++) {
+        if (buf[i] == pat[fs->k]) fs->k++;
+        else fs->k = (buf[i] == pat[0]) ? 1 : 0;
+        if (fs->k == plen) { (*frames)++; fs->k = 0; }
+
+        if (buf[i] == busy_frame[fs->bk]) fs->bk++;
+        else fs->bk = (buf[i] == busy_frame[0]) ? 1 : 0;
+        if (fs->bk == blen) { (*busy)++; fs->bk = 0; }
+    }
+}
+
+//capatul "client" al unui socketpair; numara raspunsurile dupa MSG_END
+static int sink_fd[2];
+static Conn *sink_conn;
+static atomic_long sink_frames, sink_busy;
+
+static void* sink_thread(void *arg) {
+    (void)arg;
+    FrameScan fs = {0, 0};
+    char buf[65536];
+
+    while (1) {
+        ssize_t n = recv(sink_fd[1], buf, sizeof(buf), 0);
+        if (n <= 0) break;
+        long frames = 0, busy = 0;
+        scan_frames(&fs, buf, n, &frames, &busy);
+        //busy inaintea cadrelor: cine vede cadrele vede si refuzurile lor
+        atomic_fetch_add(&sink_busy, busy);
+        atomic_fetch_add(&sink_frames, frames);
+    }
+    return NULL;
+}
+
+static void wait_frames(long target) {
+    while (atomic_load(&sink_frames) < target) sched_yield();
+}
+
+static void bench_xml(int n) {
+    make_trains(n);
+
+    long long t0 = now_ns();
+    saveToXML();
+    record("saveToXML", n, 1, now_ns() - t0);
+
+    t0 = now_ns();
+    loadXML();
+    record("loadXML", n, 1, now_ns() - t0);
+
+    //loadXML regenereaza rutele/facilitatile; revenim la flota cunoscuta
+    make_trains(n);
+}
+
+static void bench_get_status(int n) {
+    long it = iters_for(n, 2000000, 1, 1000);
+    volatile const char *s = NULL;
+
+    long long t0 = now_ns();
+    for (long k = 0; k < it; k++)
+        for (int i = 0; i < n; i++)
+            s = get_status(trains[i].dep_h, trains[i].dep_m, trains[i].delay, true);
+    record("get_status", n, it * n, now_ns() - t0);
+    (void)s;
+}
+
+static void bench_handler(const char *name, void (*handler)(Conn*, char*), int n) {
+    long it = iters_for(n, 2000000, 1, 1000);
+    long base = atomic_load(&sink_frames);
+    char args[1] = "";
+
+    long long t0 = now_ns();
+    for (long k = 0; k < it; k++) handler(sink_conn, args);
+    wait_frames(base + it);
+    record(name, n, it, now_ns() - t0);
+}
+
+//drumul complet coada -> worker_thread -> cmd_table -> send_response; cererile care
+//asteapta peste tinta benzii primesc "Server busy" si nu sunt numarate ca servite
+static void bench_dispatch(const char *name, const char *fmt, int n, long it) {
+    long base = atomic_load(&sink_frames);
+    long busy_base = atomic_load(&sink_busy);
+    char cmd[64];
+
+    long long t0 = now_ns();
+    for (long k = 0; k < it; k++) {
+        snprintf(cmd, sizeof(cmd), fmt, (int)((k * 7919) % n));
+        while (enqueue_request(sink_conn, "", cmd) < 0) sched_yield();
+    }
+    wait_frames(base + it);
+    long long ns = now_ns() - t0;
+    long busy = atomic_load(&sink_busy) - busy_base;
+    record_shed(name, n, it - busy, busy, 0, ns);
+}
+
+static int board_rx = -1;
+
+//receptor pe loopback: se aboneaza la grup, ca un afisaj din gara
+static int board_receiver(void) {
+    int fd = socket(AF_INET, SOCK_DGRAM, 0);
+    int opt = 1, rcvbuf = 8 << 20;
+    struct sockaddr_in addr = {
+        .sin_family = AF_INET,
+        .sin_port = board_addr.sin_port,
+        .sin_addr.s_addr = htonl(INADDR_ANY)
+    };
+    struct ip_mreq mreq = { .imr_multiaddr = board_addr.sin_addr, .imr_interface = board_if };
+    struct timeval tv = {2, 0};
+
+    setsockopt(fd, SOL_SOCKET, SO_REUSEADDR, &opt, sizeof(opt));
+    setsockopt(fd, SOL_SOCKET, SO_RCVBUF, &rcvbuf, sizeof(rcvbuf));
+    setsockopt(fd, SOL_SOCKET, SO_RCVTIMEO, &tv, sizeof(tv));
+    if (bind(fd, (struct sockaddr*)&addr, sizeof(addr)) < 0 ||
+        setsockopt(fd, IPPROTO_IP, IP_ADD_MEMBERSHIP, &mreq, sizeof(mreq)) < 0) {
+        perror("board receiver");
+        close(fd);
+        return -1;
+    }
+    return fd;
+}
+
+//asteapta toate fragmentele unui panou mai nou decat `after`; intoarce seq sau 0 la gaura/timeout
+static uint32_t board_wait(uint32_t after, long *datagrams, long *bad) {
+    uint8_t pkt[BOARD_HDR_LEN + BOARD_PAYLOAD];
+    uint32_t cur = 0;
+    long got = 0;
+
+    while (1) {
+        ssize_t n = recv(board_rx, pkt, sizeof(pkt), 0);
+        if (n < BOARD_HDR_LEN) return 0;
+        (*datagrams)++;
+
+        uint32_t seq, crc;
+        uint16_t frag, nfrags, len;
+        memcpy(&seq, pkt + 4, 4);     seq = ntohl(seq);
+        memcpy(&frag, pkt + 8, 2);    frag = ntohs(frag);
+        memcpy(&nfrags, pkt + 10, 2); nfrags = ntohs(nfrags);
+        memcpy(&len, pkt + 12, 2);    len = ntohs(len);
+        memcpy(&crc, pkt + 16, 4);    crc = ntohl(crc);
+
+        if (memcmp(pkt, BOARD_MAGIC, 4) != 0 || n != (ssize_t)(BOARD_HDR_LEN + len) ||
+            crc32_ieee((char*)pkt + BOARD_HDR_LEN, len) != crc) {
+            (*bad)++;
+            continue;
+        }
+        if (seq <= after) continue;
+        if (seq != cur) { cur = seq; got = 0; }
+        if (frag != got) return 0;
+        if (++got == nfrags) return seq;
+    }
+}
+
+//de la modificare pana la panoul complet primit prin multicast; costul nu depinde de numarul de afisaje
+static void bench_board(int n) {
+    static bool started = false;
+    long it = iters_for(n, 200000, 1, 200);
+    long datagrams = 0, bad = 0, gaps = 0;
+
+    if (!started) {
+        board_addr.sin_family = AF_INET;
+        board_addr.sin_port = htons(5007);
+        inet_pton(AF_INET, "239.255.42.1", &board_addr.sin_addr);
+        inet_pton(AF_INET, "127.0.0.1", &board_if);
+        board_rx = board_receiver();
+        if (board_rx < 0) return;
+        int sock = board_socket();
+        if (sock < 0) {
+            perror("board socket");
+            close(board_rx);
+            board_rx = -1;
+            return;
+        }
+        board_enabled = true;
+
+        pthread_t t;
+        pthread_create(&t, NULL, board_publisher, (void*)(intptr_t)sock);
+        pthread_detach(t);
+        started = true;
+    }
+    if (board_rx < 0) return;
+
+    //panoul initial (sau cel ramas de la flota anterioara)
+    pthread_mutex_lock(&board_mutex);
+    uint32_t last = board_seq;
+    pthread_mutex_unlock(&board_mutex);
+
+    long long t0 = now_ns();
+    for (long k = 0; k < it; k++) {
+        board_changed();
+        uint32_t seq = board_wait(last, &datagrams, &bad);
+        if (seq) {
+            last = seq;
+        } else {
+            //gaura: un afisaj real ar cere BOARD pe TCP
+            gaps++;
+            pthread_mutex_lock(&board_mutex);
+            last = board_seq;
+            pthread_mutex_unlock(&board_mutex);
+        }
+    }
+    long long total = now_ns() - t0;
+
+    fprintf(out, "{\"tag\":\"%s\",\"bench\":\"board_multicast\",\"trains\":%d,\"ops\":%ld,"
+                 "\"total_ns\":%lld,\"ns_per_op\":%.1f,\"datagrams\":%ld,\"crc_errors\":%ld,\"gaps\":%ld}\n",
+            tag, n, it, total, (double)total / it, datagrams, bad, gaps);
+    fflush(out);
+    fprintf(stderr, "%-22s trains=%-8d ops=%-8ld %12.1f ns/op   datagrams=%ld crc_errors=%ld gaps=%ld\n",
+            "board_multicast", n, it, (double)total / it, datagrams, bad, gaps);
+}
+
+static int listen_fd;
+
+static void* accept_thread(void *arg) {
+    (void)arg;
+    while (1) {
+        int cfd = accept(listen_fd, NULL, NULL);
+        if (cfd < 0) continue;
+        Conn *c = conn_new(cfd);
+        if (!c) { close(cfd); continue; }
+
+        pthread_t t;
+        pthread_create(&t, NULL, client_handler, c);
+        pthread_detach(t);
+    }
+    return NULL;
+}
+
+typedef struct { int port; long reqs; const char *cmd; int burst; atomic_long busy; } LoopbackJob;
+
+static int connect_loopback(int port) {
+    int sock = socket(AF_INET, SOCK_STREAM, 0);
+    struct sockaddr_in serv = {
+        .sin_family = AF_INET,
+        .sin_port = htons(port),
+        .sin_addr.s_addr = htonl(INADDR_LOOPBACK)
+    };
+    if (connect(sock, (struct sockaddr *)&serv, sizeof(serv)) < 0) {
+        perror("connect");
+        exit(1);
+    }
+    return sock;
+}
+
+//trimite cmd de `count` ori si asteapta `count` raspunsuri; intoarce cate au fost "busy"
+static long roundtrip(int sock, const char *cmd, int count) {
+    FrameScan fs = {0, 0};
+    long frames = 0, busy = 0;
+    char buf[65536];
+
+    for (int i = 0; i < count; i++)
+        send(sock, cmd, strlen(cmd), MSG_NOSIGNAL);
+
+    while (frames < count) {
+        ssize_t n = recv(sock, buf, sizeof(buf), 0);
+        if (n <= 0) { fprintf(stderr, "loopback: server closed\n"); exit(1); }
+        scan_frames(&fs, buf, n, &frames, &busy);
+    }
+    return busy;
+}
+
+//client blocant, ca client.c: trimite o comanda si asteapta MSG_END
+static void* loopback_client(void *arg) {
+    LoopbackJob *job = arg;
+    int sock = connect_loopback(job->port);
+
+    long busy = 0;
+    for (long r = 0; r < job->reqs; r++) busy += roundtrip(sock, job->cmd, 1);
+    atomic_fetch_add(&job->busy, busy);
+    close(sock);
+    return NULL;
+}
+
+static atomic_int storm_stop;
+
+//citiri in rafale, pana cand scriitorul termina
+static void* storm_client(void *arg) {
+    LoopbackJob *job = arg;
+    int sock = connect_loopback(job->port);
+
+    while (!atomic_load(&storm_stop)) roundtrip(sock, job->cmd, job->burst);
+    close(sock);
+    return NULL;
+}
+
+static int cmp_ll(const void *a, const void *b) {
+    long long x = *(const long long*)a, y = *(const long long*)b;
+    return (x > y) - (x < y);
+}
+
+//latenta UPDATE cat timp alti clienti bombardeaza serverul cu DEPARTURES si SCHEDULE
+static void bench_write_storm(int port, int n) {
+    long writes = iters_for(n, 2000000, 5, 200);
+    long long *lat = malloc((size_t)writes * sizeof(long long));
+    LoopbackJob reads = { port, 0, "DEPARTURES\n", 16, 0 };
+    LoopbackJob bulk = { port, 0, "SCHEDULE\n", 2, 0 };
+    pthread_t t[BENCH_CLIENTS + 1];
+    long shed_before = lanes[LANE_READ].shed + lanes[LANE_BULK].shed;
+
+    atomic_store(&storm_stop, 0);
+    for (int i = 0; i < BENCH_CLIENTS; i++)
+        pthread_create(&t[i], NULL, storm_client, &reads);
+    pthread_create(&t[BENCH_CLIENTS], NULL, storm_client, &bulk);
+
+    int sock = connect_loopback(port);
+    char cmd[64];
+    long long t0 = now_ns();
+    for (long k = 0; k < writes; k++) {
+        snprintf(cmd, sizeof(cmd), "UPDATE T0000001 %ld\n", k % 30 + 1);
+        long long s0 = now_ns();
+        roundtrip(sock, cmd, 1);
+        lat[k] = now_ns() - s0;
+    }
+    long long total = now_ns() - t0;
+    close(sock);
+
+    atomic_store(&storm_stop, 1);
+    for (int i = 0; i <= BENCH_CLIENTS; i++)
+        pthread_join(t[i], NULL);
+
+    qsort(lat, (size_t)writes, sizeof(long long), cmp_ll);
+    long shed = lanes[LANE_READ].shed + lanes[LANE_BULK].shed - shed_before;
+
+    fprintf(out, "{\"tag\":\"%s\",\"bench\":\"write_under_read_storm\",\"trains\":%d,\"ops\":%ld,"
+                 "\"total_ns\":%lld,\"p50_ns\":%lld,\"p99_ns\":%lld,\"reads_shed\":%ld}\n",
+            tag, n, writes, total, lat[writes / 2], lat[(writes * 99) / 100], shed);
+    fflush(out);
+    fprintf(stderr, "%-22s trains=%-8d ops=%-8ld p50 %10.1f us  p99 %10.1f us  shed=%ld\n",
+           "write_under_read_storm", n, writes,
+           lat[writes / 2] / 1e3, lat[(writes * 99) / 100] / 1e3, shed);
+    free(lat);
+}
+
+static void bench_loopback(const char *name, const char *cmd, int port, int n) {
+    long per_client = iters_for(n, 5000000, 4, 2000) / BENCH_CLIENTS;
+    if (per_client < 1) per_client = 1;
+
+    pthread_t t[BENCH_CLIENTS];
+    LoopbackJob job = { port, per_client, cmd, 1, 0 };
+
+    long long t0 = now_ns();
+    for (int i = 0; i < BENCH_CLIENTS; i++)
+        pthread_create(&t[i], NULL, loopback_client, &job);
+    for (int i = 0; i < BENCH_CLIENTS; i++)
+        pthread_join(t[i], NULL);
+    long long ns = now_ns() - t0;
+    long busy = atomic_load(&job.busy);
+    record_shed(name, n, per_client * BENCH_CLIENTS - busy, busy, 0, ns);
+}
+
+typedef struct { long done, ok, busy, lost, bad; } PipeStats;
+
+//contextul unei cereri: raspunsul trebuie sa fie al ei, nu al alteia din zbor
+typedef struct {
+    PipeStats *st;
+    bool schedule;
+    char expect[48];
+} PipeReq;
+
+static void pipe_done(void *user, int status, const char *reply, size_t len) {
+    PipeReq *rq = user;
+    PipeStats *st = rq->st;
+    st->done++;
+    if (status == TC_BUSY) st->busy++;
+    else if (status == TC_EDISCONNECT) st->lost++;
+    else {
+        st->ok++;
+        size_t elen = strlen(rq->expect);
+        bool ok = rq->schedule ? len >= elen && memcmp(reply, rq->expect, elen) == 0
+                               : memmem(reply, len, rq->expect, elen) != NULL;
+        if (!ok) {
+            if (st->bad++ == 0)
+                fprintf(stderr, "reply mismatch: expected \"%s\", got \"%.*s\"\n",
+                        rq->expect, (int)(len < 80 ? len : 80), reply);
+        }
+    }
+    free(rq);
+}
+
+//libtrainclient: PIPELINE_DEPTH cereri in zbor peste nconns conexiuni; fiecare
+//sched_every-a cerere e SCHEDULE (0 = doar DETAILS), deci raspunsurile de pe
+//benzile read si bulk se intorc in alta ordine decat au plecat
+static void bench_pipelined(const char *name, int port, int n, int nconns,
+                            long total, int sched_every) {
+    tc_pool *pool = tc_pool_create("127.0.0.1", port, nconns);
+    PipeStats st = {0, 0, 0, 0, 0};
+    char cmd[64];
+    long sent = 0;
+
+    if (!pool) { perror("tc_pool_create"); return; }
+
+    long long t0 = now_ns();
+    while (st.done < total) {
+        while (sent < total && tc_pool_inflight(pool) < PIPELINE_DEPTH) {
+            PipeReq *rq = malloc(sizeof(*rq));
+            if (!rq) break;
+            rq->st = &st;
+            rq->schedule = sched_every > 0 && sent % sched_every == 0;
+            if (rq->schedule) {
+                snprintf(cmd, sizeof(cmd), "SCHEDULE");
+                snprintf(rq->expect, sizeof(rq->expect), "\n--- DAILY SCHEDULE ---");
+            } else {
+                int id = (int)((sent * 7919) % n);
+                snprintf(cmd, sizeof(cmd), "DETAILS T%07d", id);
+                snprintf(rq->expect, sizeof(rq->expect), "TRAIN DETAILS: T%07d", id);
+            }
+            if (tc_pool_submit(pool, cmd, pipe_done, rq) < 0) {
+                free(rq);
+                break;
+            }
+            sent++;
+        }
+        if (tc_pool_poll(pool, 1000) < 0) break;
+    }
+    long long ns = now_ns() - t0;
+    tc_pool_destroy(pool);
+
+    record_shed(name, n, st.ok, st.busy, st.lost, ns);
+    if (st.bad) {
+        fprintf(stderr, "%-22s %ld replies did not match their request\n", name, st.bad);
+        exit(1);
+    }
+    if (st.lost) {
+        fprintf(stderr, "%-22s %ld requests lost their connection\n", name, st.lost);
+        exit(1);
+    }
+}
+
+static int start_loopback_server(void) {
+    listen_fd = socket(AF_INET, SOCK_STREAM, 0);
+    struct sockaddr_in addr = {
+        .sin_family = AF_INET,
+        .sin_port = 0,
+        .sin_addr.s_addr = htonl(INADDR_LOOPBACK)
+    };
+    socklen_t alen = sizeof(addr);
+
+    if (bind(listen_fd, (struct sockaddr*)&addr, sizeof(addr)) < 0 ||
+        listen(listen_fd, 64) < 0 ||
+        getsockname(listen_fd, (struct sockaddr*)&addr, &alen) < 0) {
+        perror("loopback listen");
+        exit(1);
+    }
+
+    pthread_t t;
+    pthread_create(&t, NULL, accept_thread, NULL);
+    pthread_detach(t);
+    return ntohs(addr.sin_port);
+}
+
+static void usage(const char *argv0) {
+    fprintf(stderr, "Usage: %s [-o results.jsonl] [-n 1000,100000,...] [-t tag]\n", argv0);
+    exit(2);
+}
+
+int main(int argc, char **argv) {
+    const char *out_path = "bench_results.jsonl";
+    const char *size_list = "1000,100000,1000000";
+    int sizes[MAX_SIZES], nsizes = 0;
+    int opt;
+
+    while ((opt = getopt(argc, argv, "o:n:t:")) != -1) {
+        if (opt == 'o') out_path = optarg;
+        else if (opt == 'n') size_list = optarg;
+        else if (opt == 't') tag = optarg;
+        else usage(argv[0]);
+    }
+
+    for (const char *p = size_list; *p && nsizes < MAX_SIZES; ) {
+        int v = atoi(p);
+        if (v <= 0) usage(argv[0]);
+        sizes[nsizes++] = v;
+        p = strchr(p, ',');
+        if (!p) break;
+        p++;
+    }
+
+    out = fopen(out_path, "a");
+    if (!out) { perror(out_path); return 1; }
+
+    //loadXML/saveToXML lucreaza pe ./trains.xml, deci rulam intr-un director temporar
+    char dir[] = "/tmp/train-bench-XXXXXX";
+    char cwd[1024];
+    if (!getcwd(cwd, sizeof(cwd)) || !mkdtemp(dir) || chdir(dir) < 0) {
+        perror("bench dir");
+        return 1;
+    }
+
+    //jurnalul serverului (UPDATE etc.) nu ne intereseaza aici; rezultatele merg pe stderr
+    if (!freopen("/dev/null", "w", stdout)) perror("/dev/null");
+
+    signal(SIGPIPE, SIG_IGN);
+    snprintf(busy_frame, sizeof(busy_frame), "%s%s", busy_msg, MSG_END);
+    socketpair(AF_UNIX, SOCK_STREAM, 0, sink_fd);
+    sink_conn = conn_new(sink_fd[0]);
+    pthread_t st, sr;
+    pthread_create(&st, NULL, sink_thread, NULL);
+    //ca pentru orice client, raspunsurile care nu intra in socket sunt golite de cititor
+    conn_get(sink_conn);
+    pthread_create(&sr, NULL, client_handler, sink_conn);
+
+    pthread_t w[WORKER_THREADS], sv;
+    for (int i = 0; i < WORKER_THREADS; i++)
+        pthread_create(&w[i], NULL, worker_thread, NULL);
+    pthread_create(&sv, NULL, saver_thread, NULL);
+
+    int port = start_loopback_server();
+
+    for (int s = 0; s < nsizes; s++) {
+        int n = sizes[s];
+
+        bench_xml(n);
+        bench_get_status(n);
+        bench_handler("cmd_departures", cmd_departures, n);
+        bench_handler("cmd_schedule", cmd_schedule, n);
+        bench_board(n);
+        bench_dispatch("dispatch_unknown", "NOP %d", n, 100000);
+        bench_dispatch("dispatch_details", "DETAILS T%07d", n, iters_for(n, 20000000, 10, 100000));
+        bench_loopback("loopback_departures", "DEPARTURES\n", port, n);
+        bench_loopback("loopback_details", "DETAILS T0000001\n", port, n);
+        bench_pipelined("pipelined_details", port, n, BENCH_CLIENTS,
+                        iters_for(n, 50000000, 64, 50000), 0);
+        bench_pipelined("pipelined_mixed", port, n, 1,
+                        iters_for(n, 5000000, 64, 5000), 16);
+        bench_write_storm(port, n);
+    }
+
+    flush_saves();
+    unlink("trains.xml");
+    if (chdir(cwd) == 0) rmdir(dir);
+    fclose(out);
+    fprintf(stderr, "Results appended to %s\n", out_path);
+    return 0;
+}
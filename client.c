@@ -1,11 +1,10 @@
 #include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
-#include <arpa/inet.h>
-#include <unistd.h>
 
-#define PORT 8080
-#define MSG_END "\n==END==\n"
+#include "trainclient.h"
+
+#define PORT TC_DEFAULT_PORT
 
 //am facut un trenulet cute 
 void print_train_logo() {
@@ -21,40 +20,9 @@ void print_train_logo() {
     printf("\033[0m\n"); 
 }
 
-static int recv_until_end(int sock, char *out, size_t out_sz) {
-    size_t used = 0;
-    out[0] = 0;
-
-    while (1) {
-        char buf[1024];
-        ssize_t n = recv(sock, buf, sizeof(buf) - 1, 0);
-        if (n <= 0) return -1;
-
-        buf[n] = 0;
-
-        size_t to_copy = (size_t)n;
-        if (used + to_copy >= out_sz) to_copy = out_sz - used - 1;
-
-        memcpy(out + used, buf, to_copy);
-        used += to_copy;
-        out[used] = 0;
-
-        char *p = strstr(out, MSG_END);
-        if (p) { *p = 0; return 0; }
-
-        if (used >= out_sz - 1) return 0;
-    }
-}
-
 int main(void) {
-    int sock = socket(AF_INET, SOCK_STREAM, 0);
-    struct sockaddr_in serv = {
-        .sin_family = AF_INET,
-        .sin_port = htons(PORT),
-        .sin_addr.s_addr = inet_addr("127.0.0.1")
-    };
-
-    if (connect(sock, (struct sockaddr *)&serv, sizeof(serv)) < 0) {
+    tc_conn *conn = tc_connect("127.0.0.1", PORT);
+    if (!conn) {
         perror("connect");
         return 1;
     }
@@ -77,7 +45,7 @@ int main(void) {
     printf(" [10] EXIT\n");
     printf("----------------------------------------------------------------\n");
 
-    char msg[256], recvbuf[8192];
+    char msg[256];
 
     while (1) {
         printf("> ");
@@ -88,17 +56,23 @@ int main(void) {
         if (strcmp(msg, "EXIT") == 0) break;
         if (msg[0] == 0) continue;
 
-        strcat(msg, "\n");
-        send(sock, msg, strlen(msg), 0);
+        tc_future *f = tc_submit_future(conn, msg);
+        if (!f) {
+            printf("Invalid command (max %d characters).\n", TC_MAX_COMMAND);
+            continue;
+        }
 
-        if (recv_until_end(sock, recvbuf, sizeof(recvbuf)) < 0) {
+        tc_future_wait(f, -1);
+        if (tc_future_status(f) == TC_EDISCONNECT) {
             printf("Server disconnected.\n");
+            tc_future_free(f);
             break;
         }
 
-        printf("%s\n", recvbuf);
+        printf("%s\n", tc_future_reply(f, NULL));
+        tc_future_free(f);
     }
 
-    close(sock);
+    tc_close(conn);
     return 0;
 }
\ No newline at end of file
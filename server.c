@@ -3,6 +3,7 @@
 #include <string.h>
 #include <unistd.h>
 #include <pthread.h>
+#include <sched.h>
 #include <arpa/inet.h>
 #include <time.h>
 #include <signal.h>
@@ -11,11 +12,35 @@
 #include <sys/select.h>
 #include <sys/time.h>
 #include <sys/types.h>
+#include <sys/socket.h>
+#include <sys/uio.h>
+#include <sys/eventfd.h>
+#include <sys/ioctl.h>
+#include <linux/sockios.h>
+#include <poll.h>
+#include <stdarg.h>
+#include <stdint.h>
 
 #define PORT 8080
-#define QUEUE_SIZE 50
+#define QUEUE_SIZE 256
 #define WORKER_THREADS 4
+#define READ_WORKERS (WORKER_THREADS - 2)
+#define BULK_WORKERS 1
+#define BULK_QUEUE 8
+#define READ_TARGET_MS 250
+#define BULK_TARGET_MS 1000
 #define MSG_END "\n==END==\n"
+#define TAG_LEN 16
+#define OUT_INITIAL 4096
+#define OUT_KEEP (1 << 20)
+#define RENDER_BATCH 4096
+#define CONN_OUT_HIGH (8 << 20)
+#define CONN_STALL_MS 30000
+#define WRITE_RETRY_MS 5
+#define BOARD_MAGIC "TRNB"
+#define BOARD_HDR_LEN 20
+#define BOARD_PAYLOAD 1200
+#define BOARD_MAX_FRAGS 0xFFFF
 
 typedef struct {
     char id[15];
@@ -27,30 +52,200 @@ typedef struct {
     char route[64];     
 } Train;
 
+typedef enum { LANE_WRITE, LANE_READ, LANE_BULK, LANE_COUNT } Lane;
+
+//o conexiune client; fiecare cerere din cozi tine o referinta, ca fd-ul sa nu fie
+//inchis (si refolosit de urmatorul accept) cat timp mai exista raspunsuri pentru el
+typedef struct {
+    int fd;
+    int wake_fd;        //eventfd: trezeste thread-ul cititor cand coada de iesire nu mai e goala
+    int refs;
+    bool closed;        //clientul a plecat; raspunsurile ramase se arunca
+    pthread_mutex_t lock;
+    pthread_mutex_t send_lock;  //doua raspunsuri catre acelasi client nu se amesteca
+    //ce nu a incaput in socket; golita de thread-ul cititor (sub send_lock)
+    char  *out;
+    size_t out_off, out_len, out_cap;
+    long long out_progress_ms;  //ultima data cand coada de iesire a avansat
+    int out_kernel;             //octeti netrimisi in socket la ultima verificare (SIOCOUTQ)
+} Conn;
+
 typedef struct {
-    int client_fd;
+    Conn *conn;
+    int cmd;            //index in cmd_table, -1 = comanda necunoscuta
+    long long enq_ms;
+    char tag[TAG_LEN];  //"@<tag> " din cerere, intors in raspuns ("" = fara tag)
     char command[256];
 } Request;
 
+//o coada per banda; benzile sunt servite in ordinea prioritatii (write > read > bulk)
+typedef struct {
+    const char *name;
+    int limit;          //cereri in asteptare acceptate
+    int workers;        //cati workeri pot lucra simultan pe banda
+    int target_ms;      //cererile care au asteptat mai mult sunt refuzate (0 = niciodata)
+    Request items[QUEUE_SIZE];
+    int head, tail, count, active;
+    long shed;
+} LaneQueue;
+
 static Train *trains = NULL;
 static int trainCount = 0;
 static int trainCapacity = 0;
 static volatile sig_atomic_t reload_flag = 0;
 
-static Request queue[QUEUE_SIZE];
-static int head = 0, tail = 0, qcount = 0;
+//scrierile nu sunt aruncate: cand banda write e plina, clientul nu mai e citit pana
+//se face loc (vezi client_handler); citirile nu pot ocupa toti workerii
+static LaneQueue lanes[LANE_COUNT] = {
+    [LANE_WRITE] = { "write", QUEUE_SIZE, WORKER_THREADS, 0 },
+    [LANE_READ]  = { "read",  QUEUE_SIZE, READ_WORKERS,   READ_TARGET_MS },
+    [LANE_BULK]  = { "bulk",  BULK_QUEUE, BULK_WORKERS,   BULK_TARGET_MS },
+};
+
+static const char *busy_msg = "Server busy. Please retry.";
 
 static pthread_mutex_t queue_mutex = PTHREAD_MUTEX_INITIALIZER;
 static pthread_cond_t  queue_cond  = PTHREAD_COND_INITIALIZER;
 static pthread_mutex_t train_mutex = PTHREAD_MUTEX_INITIALIZER;
-static pthread_mutex_t send_mutex  = PTHREAD_MUTEX_INITIALIZER;
+
+//trains.xml e rescris de saver_thread, nu de comanda care a modificat flota
+static pthread_mutex_t save_mutex = PTHREAD_MUTEX_INITIALIZER;
+static pthread_cond_t  save_cond  = PTHREAD_COND_INITIALIZER;
+static pthread_cond_t  save_done  = PTHREAD_COND_INITIALIZER;
+static bool save_pending = false, save_busy = false;
+static pthread_mutex_t save_file_mutex = PTHREAD_MUTEX_INITIALIZER;
+
+//buffer de raspuns append-only; fiecare worker isi refoloseste propriul buffer
+typedef struct {
+    char  *data;
+    size_t len, cap;
+    bool   failed;
+} OutBuf;
+
+static __thread OutBuf worker_out;
+
+//tag-ul cererii servite acum de acest thread; send_frame il pune inaintea raspunsului
+static __thread const char *reply_tag = "";
+
+//panoul plecari/sosiri publicat prin multicast; board_version creste la fiecare modificare
+static pthread_mutex_t board_mutex = PTHREAD_MUTEX_INITIALIZER;
+static pthread_cond_t  board_cond  = PTHREAD_COND_INITIALIZER;
+static unsigned long board_version = 0;
+static uint32_t board_seq = 0;
+static char  *board_snap = NULL;
+static size_t board_snap_len = 0;
+static bool board_enabled = false;
+static struct sockaddr_in board_addr;
+static struct in_addr board_if;
+
+static long long mono_ms(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (long long)ts.tv_sec * 1000 + ts.tv_nsec / 1000000;
+}
+
+static Conn* conn_new(int fd) {
+    Conn *c = calloc(1, sizeof(*c));
+    if (!c) return NULL;
+    c->fd = fd;
+    c->wake_fd = eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC);
+    if (c->wake_fd < 0) {
+        free(c);
+        return NULL;
+    }
+    c->refs = 1;
+    pthread_mutex_init(&c->lock, NULL);
+    pthread_mutex_init(&c->send_lock, NULL);
+    return c;
+}
+
+static void conn_get(Conn *c) {
+    pthread_mutex_lock(&c->lock);
+    c->refs++;
+    pthread_mutex_unlock(&c->lock);
+}
+
+static void conn_put(Conn *c) {
+    pthread_mutex_lock(&c->lock);
+    int left = --c->refs;
+    pthread_mutex_unlock(&c->lock);
+    if (left > 0) return;
+
+    close(c->fd);
+    close(c->wake_fd);
+    free(c->out);
+    pthread_mutex_destroy(&c->lock);
+    pthread_mutex_destroy(&c->send_lock);
+    free(c);
+}
+
+static bool conn_closed(Conn *c) {
+    pthread_mutex_lock(&c->lock);
+    bool closed = c->closed;
+    pthread_mutex_unlock(&c->lock);
+    return closed;
+}
+
+//clientul a inchis: nu mai citim, dar fd-ul ramane al nostru pana la ultimul conn_put
+static void conn_shutdown(Conn *c) {
+    pthread_mutex_lock(&c->lock);
+    c->closed = true;
+    pthread_mutex_unlock(&c->lock);
+    shutdown(c->fd, SHUT_RD);
+}
+
+//client care nu isi citeste raspunsurile (sau socket stricat): il deconectam
+static void conn_drop(Conn *c) {
+    pthread_mutex_lock(&c->lock);
+    c->closed = true;
+    pthread_mutex_unlock(&c->lock);
+    shutdown(c->fd, SHUT_RDWR);
+}
+
+//trimite cat se poate din coada de iesire fara sa blocheze; -1 = eroare de socket
+//apelat cu send_lock tinut
+static int conn_flush(Conn *c) {
+    while (c->out_off < c->out_len) {
+        ssize_t n = send(c->fd, c->out + c->out_off, c->out_len - c->out_off,
+                         MSG_NOSIGNAL | MSG_DONTWAIT);
+        if (n < 0 && errno == EINTR) continue;
+        if (n < 0 && (errno == EAGAIN || errno == EWOULDBLOCK)) return 0;
+        if (n <= 0) return -1;
+        c->out_off += (size_t)n;
+        c->out_progress_ms = mono_ms();
+    }
+    c->out_off = c->out_len = 0;
+    if (c->out_cap > OUT_KEEP) {
+        free(c->out);
+        c->out = NULL;
+        c->out_cap = 0;
+    }
+    return 0;
+}
+
+static void board_changed(void) {
+    pthread_mutex_lock(&board_mutex);
+    board_version++;
+    pthread_cond_signal(&board_cond);
+    pthread_mutex_unlock(&board_mutex);
+}
 
 void handle_sigusr1(int sig) { (void)sig; reload_flag = 1; }
 
+//echivalent cu "%02d:%02d" pentru 0 <= h, m <= 99; scrie exact 5 caractere
+static void fmt_hhmm(char *p, int h, int m) {
+    p[0] = (char)('0' + h / 10);
+    p[1] = (char)('0' + h % 10);
+    p[2] = ':';
+    p[3] = (char)('0' + m / 10);
+    p[4] = (char)('0' + m % 10);
+}
+
 static void computeETA(Train *t) {
     int total = t->arr_h * 60 + t->arr_m + t->delay;
     total = (total % 1440 + 1440) % 1440;
-    snprintf(t->eta, sizeof(t->eta), "%02d:%02d", total / 60, total % 60);
+    fmt_hhmm(t->eta, total / 60, total % 60);
+    t->eta[5] = 0;
 }
 
 const char* get_status(int h, int m, int delay, bool is_departure) {
@@ -77,26 +272,235 @@ static int isWithinNextHour(int h, int m, int delay) {
     return (diff >= 0 && diff <= 60);
 }
 
-static void send_response(int fd, const char *text) {
-    pthread_mutex_lock(&send_mutex);
-    send(fd, text, strlen(text), MSG_NOSIGNAL);
-    send(fd, MSG_END, strlen(MSG_END), MSG_NOSIGNAL);
-    pthread_mutex_unlock(&send_mutex);
+static bool ob_reserve(OutBuf *b, size_t extra) {
+    if (b->failed) return false;
+    if (b->len + extra < b->cap) return true;
+
+    size_t cap = b->cap ? b->cap : OUT_INITIAL;
+    while (b->len + extra >= cap) cap *= 2;
+    char *d = realloc(b->data, cap);
+    if (!d) { b->failed = true; return false; }
+    b->data = d;
+    b->cap = cap;
+    return true;
+}
+
+static OutBuf* out_begin(void) {
+    worker_out.len = 0;
+    worker_out.failed = false;
+    ob_reserve(&worker_out, 0);
+    return &worker_out;
+}
+
+static void ob_put(OutBuf *b, const char *s, size_t n) {
+    if (!ob_reserve(b, n)) return;
+    memcpy(b->data + b->len, s, n);
+    b->len += n;
+}
+
+static void ob_puts(OutBuf *b, const char *s) { ob_put(b, s, strlen(s)); }
+
+static void ob_putc(OutBuf *b, char c) {
+    if (!ob_reserve(b, 1)) return;
+    b->data[b->len++] = c;
+}
+
+static void ob_int(OutBuf *b, long v) {
+    char tmp[24];
+    int i = sizeof(tmp);
+    unsigned long u = (v < 0) ? -(unsigned long)v : (unsigned long)v;
+
+    do { tmp[--i] = (char)('0' + u % 10); u /= 10; } while (u);
+    if (v < 0) tmp[--i] = '-';
+    ob_put(b, tmp + i, sizeof(tmp) - (size_t)i);
+}
+
+static void ob_printf(OutBuf *b, const char *fmt, ...) {
+    if (!ob_reserve(b, 0)) return;
+
+    va_list ap;
+    va_start(ap, fmt);
+    int n = vsnprintf(b->data + b->len, b->cap - b->len, fmt, ap);
+    va_end(ap);
+    if (n < 0) return;
+
+    if ((size_t)n >= b->cap - b->len) {
+        if (!ob_reserve(b, (size_t)n)) return;
+        va_start(ap, fmt);
+        vsnprintf(b->data + b->len, b->cap - b->len, fmt, ap);
+        va_end(ap);
+    }
+    b->len += (size_t)n;
+}
+
+static void ob_hhmm(OutBuf *b, int h, int m) {
+    if (h < 0 || h > 99 || m < 0 || m > 99) {
+        ob_printf(b, "%02d:%02d", h, m);
+        return;
+    }
+    if (!ob_reserve(b, 5)) return;
+    fmt_hhmm(b->data + b->len, h, m);
+    b->len += 5;
 }
 
+//corpul si MSG_END pleaca intr-un singur apel (sendmsg = writev + MSG_NOSIGNAL)
+//cererile cu tag primesc raspunsul precedat de linia "@<tag>", ca un client pipelined sa le poata potrivi
+static void send_frame(Conn *c, const char *text, size_t len) {
+    char hdr[TAG_LEN + 2];
+    size_t hlen = 0;
+
+    if (reply_tag[0]) hlen = (size_t)snprintf(hdr, sizeof(hdr), "@%s\n", reply_tag);
+
+    struct iovec iov[3] = {
+        { hdr, hlen },
+        { (void*)text, len },
+        { (void*)MSG_END, sizeof(MSG_END) - 1 }
+    };
+    struct msghdr msg = { .msg_iov = iov, .msg_iovlen = 3 };
+    if (conn_closed(c)) return;
+
+    //nu blocam niciodata: ce nu intra acum in socket ramane in c->out si e trimis
+    //de thread-ul cititor; asa un client lent nu tine ocupat un worker
+    pthread_mutex_lock(&c->send_lock);
+    bool drop = false;
+    bool was_empty = c->out_off == c->out_len;
+    while (was_empty && msg.msg_iovlen > 0) {
+        ssize_t n = sendmsg(c->fd, &msg, MSG_NOSIGNAL | MSG_DONTWAIT);
+        if (n < 0 && errno == EINTR) continue;
+        if (n < 0 && (errno == EAGAIN || errno == EWOULDBLOCK)) break;
+        if (n <= 0) { drop = true; break; }
+
+        //trimitere partiala: avansam prin iov
+        while (msg.msg_iovlen > 0 && (size_t)n >= msg.msg_iov->iov_len) {
+            n -= (ssize_t)msg.msg_iov->iov_len;
+            msg.msg_iov++;
+            msg.msg_iovlen--;
+        }
+        if (msg.msg_iovlen > 0) {
+            msg.msg_iov->iov_base = (char*)msg.msg_iov->iov_base + n;
+            msg.msg_iov->iov_len -= (size_t)n;
+        }
+    }
+
+    if (!drop && msg.msg_iovlen > 0) {
+        size_t rest = 0;
+        for (size_t i = 0; i < msg.msg_iovlen; i++) rest += msg.msg_iov[i].iov_len;
+
+        //coada nu are limita aici: cititorul nu mai accepta cereri peste CONN_OUT_HIGH,
+        //asa ca ea creste doar cu raspunsurile cererilor deja primite
+        if (c->out_off > 0) {
+            memmove(c->out, c->out + c->out_off, c->out_len - c->out_off);
+            c->out_len -= c->out_off;
+            c->out_off = 0;
+        }
+        if (c->out_len + rest > c->out_cap) {
+            size_t cap = c->out_cap ? c->out_cap : OUT_INITIAL;
+            while (cap < c->out_len + rest) cap *= 2;
+            char *p = realloc(c->out, cap);
+            if (!p) drop = true;
+            else { c->out = p; c->out_cap = cap; }
+        }
+        if (!drop) {
+            for (size_t i = 0; i < msg.msg_iovlen; i++) {
+                memcpy(c->out + c->out_len, msg.msg_iov[i].iov_base, msg.msg_iov[i].iov_len);
+                c->out_len += msg.msg_iov[i].iov_len;
+            }
+            if (was_empty) {
+                uint64_t one = 1;
+                c->out_progress_ms = mono_ms();
+                if (write(c->wake_fd, &one, sizeof(one)) < 0) { /* deja trezit */ }
+            }
+        }
+    }
+    pthread_mutex_unlock(&c->send_lock);
+
+    if (drop) conn_drop(c);
+}
+
+static void send_response(Conn *c, const char *text) {
+    send_frame(c, text, strlen(text));
+}
+
+static void send_out(Conn *c, OutBuf *b) {
+    if (b->failed) {
+        send_response(c, "Server Error: Out of memory.");
+    } else {
+        send_frame(c, b->data, b->len);
+    }
+
+    //dupa un raspuns urias (SCHEDULE pe o flota mare) nu tinem memoria ocupata
+    if (b->cap > OUT_KEEP) {
+        free(b->data);
+        b->data = NULL;
+        b->cap = 0;
+    }
+}
+
+//scrie flota in trains.xml.tmp si o muta peste trains.xml; train_mutex e luat pe loturi,
+//ca salvarea unei flote mari sa nu blocheze UPDATE/CANCEL cat timp scrie pe disc
 static void saveToXML(void) {
-    FILE *f = fopen("trains.xml", "w");
-    if (!f) return;
+    pthread_mutex_lock(&save_file_mutex);
+    FILE *f = fopen("trains.xml.tmp", "w");
+    if (!f) {
+        pthread_mutex_unlock(&save_file_mutex);
+        return;
+    }
     fprintf(f, "<Trains>\n");
-    for (int i = 0; i < trainCount; i++) {
-        fprintf(f, "    <Train id=\"%s\">\n", trains[i].id);
-        fprintf(f, "        <Departure>%02d:%02d</Departure>\n", trains[i].dep_h, trains[i].dep_m);
-        fprintf(f, "        <Arrival>%02d:%02d</Arrival>\n", trains[i].arr_h, trains[i].arr_m);
-        fprintf(f, "        <Delay>%d</Delay>\n", trains[i].delay);
-        fprintf(f, "    </Train>\n");
+    for (int i = 0; ; ) {
+        pthread_mutex_lock(&train_mutex);
+        int end = (trainCount - i > RENDER_BATCH) ? i + RENDER_BATCH : trainCount;
+        for (; i < end; i++) {
+            fprintf(f, "    <Train id=\"%s\">\n", trains[i].id);
+            fprintf(f, "        <Departure>%02d:%02d</Departure>\n", trains[i].dep_h, trains[i].dep_m);
+            fprintf(f, "        <Arrival>%02d:%02d</Arrival>\n", trains[i].arr_h, trains[i].arr_m);
+            fprintf(f, "        <Delay>%d</Delay>\n", trains[i].delay);
+            fprintf(f, "    </Train>\n");
+        }
+        bool more = i < trainCount;
+        pthread_mutex_unlock(&train_mutex);
+
+        if (!more) break;
+        sched_yield();
     }
     fprintf(f, "</Trains>\n");
-    fclose(f);
+    if (fclose(f) == 0) rename("trains.xml.tmp", "trains.xml");
+    else perror("trains.xml.tmp");
+    pthread_mutex_unlock(&save_file_mutex);
+}
+
+//o modificare a flotei cere o salvare; mai multe cereri in timpul unei salvari se
+//contopesc intr-una singura
+static void request_save(void) {
+    pthread_mutex_lock(&save_mutex);
+    save_pending = true;
+    pthread_cond_signal(&save_cond);
+    pthread_mutex_unlock(&save_mutex);
+}
+
+static void* saver_thread(void *arg) {
+    (void)arg;
+    while (1) {
+        pthread_mutex_lock(&save_mutex);
+        while (!save_pending) pthread_cond_wait(&save_cond, &save_mutex);
+        save_pending = false;
+        save_busy = true;
+        pthread_mutex_unlock(&save_mutex);
+
+        saveToXML();
+
+        pthread_mutex_lock(&save_mutex);
+        save_busy = false;
+        pthread_cond_broadcast(&save_done);
+        pthread_mutex_unlock(&save_mutex);
+    }
+    return NULL;
+}
+
+//asteapta pana cand toate modificarile cerute pana acum sunt in trains.xml
+static void flush_saves(void) {
+    pthread_mutex_lock(&save_mutex);
+    while (save_pending || save_busy) pthread_cond_wait(&save_done, &save_mutex);
+    pthread_mutex_unlock(&save_mutex);
 }
 
 static void loadXML(void) {
@@ -156,113 +560,140 @@ static void loadXML(void) {
 
     pthread_mutex_unlock(&train_mutex);
     fclose(f);
+    board_changed();
 }
 
-//comenzi
+//"[DELAYED by N min]" / "[EARLY by N min]" / "[ON TIME]"
+static void ob_status_detail(OutBuf *b, int delay) {
+    if (delay > 0) {
+        ob_puts(b, "[DELAYED by ");
+        ob_int(b, delay);
+        ob_puts(b, " min]");
+    } else if (delay < 0) {
+        ob_puts(b, "[EARLY by ");
+        ob_int(b, -(long)delay);
+        ob_puts(b, " min]");
+    } else {
+        ob_puts(b, "[ON TIME]");
+    }
+}
 
-static void cmd_schedule(int fd, char *args) {
-    (void)args;
-    char buf[8192] = "\n--- DAILY SCHEDULE ---\n";
+//parcurge flota in loturi de RENDER_BATCH trenuri si elibereaza train_mutex intre ele,
+//ca un UPDATE/CANCEL sa nu astepte randarea intregii flote; intoarce cate randuri au
+//fost scrise. Loturi diferite pot vedea stari diferite ale flotei.
+static int render_batched(OutBuf *b, bool (*row)(OutBuf*, const Train*)) {
+    int written = 0;
 
-    pthread_mutex_lock(&train_mutex);
-    for (int i = 0; i < trainCount; i++) {
-        char tmp[256];
-        char status_str[50];
-        
-        if (trains[i].delay == -999) {
-            strcpy(status_str, "!!! CANCELLED !!!");
-        } else {
-            sprintf(status_str, "Delay %d min", trains[i].delay);
-        }
+    for (int i = 0; ; ) {
+        pthread_mutex_lock(&train_mutex);
+        int end = (trainCount - i > RENDER_BATCH) ? i + RENDER_BATCH : trainCount;
+        for (; i < end; i++)
+            if (row(b, &trains[i])) written++;
+        bool more = i < trainCount;
+        pthread_mutex_unlock(&train_mutex);
 
-        snprintf(tmp, sizeof(tmp),
-                 "%s | Dep %02d:%02d %s | Arr %02d:%02d %s | %s | ETA %s\n",
-                 trains[i].id,
-                 trains[i].dep_h, trains[i].dep_m,
-                 get_status(trains[i].dep_h, trains[i].dep_m, trains[i].delay, true),
-                 trains[i].arr_h, trains[i].arr_m,
-                 get_status(trains[i].arr_h, trains[i].arr_m, trains[i].delay, false),
-                 status_str, trains[i].eta);
+        if (!more) break;
+        sched_yield();  //lasam un scriitor care asteapta sa prinda mutex-ul
+    }
+    return written;
+}
 
-        strncat(buf, tmp, sizeof(buf) - strlen(buf) - 1);
+static bool schedule_row(OutBuf *b, const Train *t) {
+    ob_puts(b, t->id);
+    ob_puts(b, " | Dep ");
+    ob_hhmm(b, t->dep_h, t->dep_m);
+    ob_putc(b, ' ');
+    ob_puts(b, get_status(t->dep_h, t->dep_m, t->delay, true));
+    ob_puts(b, " | Arr ");
+    ob_hhmm(b, t->arr_h, t->arr_m);
+    ob_putc(b, ' ');
+    ob_puts(b, get_status(t->arr_h, t->arr_m, t->delay, false));
+
+    if (t->delay == -999) {
+        ob_puts(b, " | !!! CANCELLED !!!");
+    } else {
+        ob_puts(b, " | Delay ");
+        ob_int(b, t->delay);
+        ob_puts(b, " min");
     }
-    pthread_mutex_unlock(&train_mutex);
 
-    send_response(fd, buf);
+    ob_puts(b, " | ETA ");
+    ob_puts(b, t->eta);
+    ob_putc(b, '\n');
+    return true;
 }
 
-static void cmd_reload(int fd, char *args) {
+//comenzi
+
+static void cmd_schedule(Conn *c, char *args) {
     (void)args;
-    loadXML();
-    send_response(fd, "Reloaded trains.xml.");
+    OutBuf *b = out_begin();
+    ob_puts(b, "\n--- DAILY SCHEDULE ---\n");
+    render_batched(b, schedule_row);
+    send_out(c, b);
 }
 
-static void cmd_departures(int fd, char *args) {
+static void cmd_reload(Conn *c, char *args) {
     (void)args;
-    char buf[4096] = "\nDEPARTURES (NEXT HOUR):\n";
-    int found = 0;
-
-    pthread_mutex_lock(&train_mutex);
-    for (int i = 0; i < trainCount; i++) {
-        if (isWithinNextHour(trains[i].dep_h, trains[i].dep_m, trains[i].delay)) {
-            char tmp[256];
-            char status_detail[64];
-
-            if (trains[i].delay > 0)
-                snprintf(status_detail, sizeof(status_detail), "[DELAYED by %d min]", trains[i].delay);
-            else if (trains[i].delay < 0)
-                snprintf(status_detail, sizeof(status_detail), "[EARLY by %d min]", -trains[i].delay);
-            else
-                snprintf(status_detail, sizeof(status_detail), "[ON TIME]");
-
-            snprintf(tmp, sizeof(tmp), "> %s | Plan %02d:%02d | %s\n",
-                     trains[i].id, trains[i].dep_h, trains[i].dep_m, status_detail);
+    flush_saves();
+    loadXML();
+    send_response(c, "Reloaded trains.xml.");
+}
 
-            strncat(buf, tmp, sizeof(buf) - strlen(buf) - 1);
-            found = 1;
-        }
-    }
-    pthread_mutex_unlock(&train_mutex);
+static bool departure_row(OutBuf *b, const Train *t) {
+    if (!isWithinNextHour(t->dep_h, t->dep_m, t->delay)) return false;
+    ob_puts(b, "> ");
+    ob_puts(b, t->id);
+    ob_puts(b, " | Plan ");
+    ob_hhmm(b, t->dep_h, t->dep_m);
+    ob_puts(b, " | ");
+    ob_status_detail(b, t->delay);
+    ob_putc(b, '\n');
+    return true;
+}
 
-    if (!found) strcat(buf, "   (No departures scheduled in the next hour)\n");
-    send_response(fd, buf);
+static void render_departures(OutBuf *b) {
+    ob_puts(b, "\nDEPARTURES (NEXT HOUR):\n");
+    if (!render_batched(b, departure_row)) ob_puts(b, "   (No departures scheduled in the next hour)\n");
 }
 
-static void cmd_arrivals(int fd, char *args) {
+static void cmd_departures(Conn *c, char *args) {
     (void)args;
-    char buf[4096] = "\nARRIVALS (NEXT HOUR):\n";
-    int found = 0;
-
-    pthread_mutex_lock(&train_mutex);
-    for (int i = 0; i < trainCount; i++) {
-        if (isWithinNextHour(trains[i].arr_h, trains[i].arr_m, trains[i].delay)) {
-            char tmp[256];
-            char status_detail[64];
-
-            if (trains[i].delay > 0)
-                snprintf(status_detail, sizeof(status_detail), "[DELAYED by %d min]", trains[i].delay);
-            else if (trains[i].delay < 0)
-                snprintf(status_detail, sizeof(status_detail), "[EARLY by %d min]", -trains[i].delay);
-            else
-                snprintf(status_detail, sizeof(status_detail), "[ON TIME]");
+    OutBuf *b = out_begin();
+    render_departures(b);
+    send_out(c, b);
+}
 
-            snprintf(tmp, sizeof(tmp), "> %s | Plan %02d:%02d | ETA %s %s\n",
-                     trains[i].id, trains[i].arr_h, trains[i].arr_m, trains[i].eta, status_detail);
+static bool arrival_row(OutBuf *b, const Train *t) {
+    if (!isWithinNextHour(t->arr_h, t->arr_m, t->delay)) return false;
+    ob_puts(b, "> ");
+    ob_puts(b, t->id);
+    ob_puts(b, " | Plan ");
+    ob_hhmm(b, t->arr_h, t->arr_m);
+    ob_puts(b, " | ETA ");
+    ob_puts(b, t->eta);
+    ob_putc(b, ' ');
+    ob_status_detail(b, t->delay);
+    ob_putc(b, '\n');
+    return true;
+}
 
-            strncat(buf, tmp, sizeof(buf) - strlen(buf) - 1);
-            found = 1;
-        }
-    }
-    pthread_mutex_unlock(&train_mutex);
+static void render_arrivals(OutBuf *b) {
+    ob_puts(b, "\nARRIVALS (NEXT HOUR):\n");
+    if (!render_batched(b, arrival_row)) ob_puts(b, "   (No arrivals scheduled in the next hour)\n");
+}
 
-    if (!found) strcat(buf, "   (No arrivals scheduled in the next hour)\n");
-    send_response(fd, buf);
+static void cmd_arrivals(Conn *c, char *args) {
+    (void)args;
+    OutBuf *b = out_begin();
+    render_arrivals(b);
+    send_out(c, b);
 }
 
-static void cmd_update(int fd, char *args) {
+static void cmd_update(Conn *c, char *args) {
     char id[15]; int d;
     if (sscanf(args, "%14s %d", id, &d) != 2) {
-        send_response(fd, "Usage: UPDATE <ID> <Delay>\n");
+        send_response(c, "Usage: UPDATE <ID> <Delay>\n");
         return;
     }
 
@@ -270,28 +701,28 @@ static void cmd_update(int fd, char *args) {
     for (int i = 0; i < trainCount; i++) {
         if (strcmp(trains[i].id, id) == 0) {
             if (trains[i].delay == -999) {
-                send_response(fd, "ERROR: Train is CANCELLED. Cannot update delay.\nUse RESET to restore service first.");
                 pthread_mutex_unlock(&train_mutex);
+                send_response(c, "ERROR: Train is CANCELLED. Cannot update delay.\nUse RESET to restore service first.");
                 return;
             }
             
             trains[i].delay = d;
             computeETA(&trains[i]);
-            saveToXML();
+            request_save();
             pthread_mutex_unlock(&train_mutex);
+            board_changed();
 
             printf("Information report: %s updated with %d min delay.\n", id, d);
-            send_response(fd, "Update successful.");
+            send_response(c, "Update successful.");
             return;
         }
     }
     pthread_mutex_unlock(&train_mutex);
-    send_response(fd, "Train not found.");
+    send_response(c, "Train not found.");
 }
 
-static void cmd_stats(int fd, char *args) {
+static void cmd_stats(Conn *c, char *args) {
     (void)args;
-    char buf[1024];
     int total = 0;
     int delayed = 0;
     int cancelled = 0;
@@ -321,7 +752,8 @@ static void cmd_stats(int fd, char *args) {
     int on_time = active_trains - delayed;
     if (on_time < 0) on_time = 0;
 
-    snprintf(buf, sizeof(buf),
+    OutBuf *b = out_begin();
+    ob_printf(b,
         "\n=== NETWORK ANALYTICS ===\n"
         " Total Trains:           %d\n"
         " -------------------------\n"
@@ -339,10 +771,10 @@ static void cmd_stats(int fd, char *args) {
         avg, max_d, worst_id,
         (cancelled > 0) ? "CRITICAL (Cancellations)" : ((delayed == 0) ? "EXCELLENT" : "WARNING"));
     
-    send_response(fd, buf);
+    send_out(c, b);
 }
 
-static void cmd_reset(int fd, char *args) {
+static void cmd_reset(Conn *c, char *args) {
     char id[15];
     
     //verif daca userul a dat un ID
@@ -357,15 +789,16 @@ static void cmd_reset(int fd, char *args) {
                 break;
             }
         }
-        saveToXML();
+        request_save();
         pthread_mutex_unlock(&train_mutex);
 
         if(found) {
-            char msg[64];
-            snprintf(msg, sizeof(msg), "Delay reset for train %s. Status is now ON TIME.", id);
-            send_response(fd, msg);
+            board_changed();
+            OutBuf *b = out_begin();
+            ob_printf(b, "Delay reset for train %s. Status is now ON TIME.", id);
+            send_out(c, b);
         } else {
-            send_response(fd, "Train ID not found.");
+            send_response(c, "Train ID not found.");
         }
     } 
     else {
@@ -375,16 +808,17 @@ static void cmd_reset(int fd, char *args) {
             trains[i].delay = 0;
             computeETA(&trains[i]);
         }
-        saveToXML();
+        request_save();
         pthread_mutex_unlock(&train_mutex);
-        send_response(fd, "ADMIN: All delays reset to 0 (Global Reset).");
+        board_changed();
+        send_response(c, "ADMIN: All delays reset to 0 (Global Reset).");
     }
 }
 
-static void cmd_cancel(int fd, char *args) {
+static void cmd_cancel(Conn *c, char *args) {
     char id[15];
     if (sscanf(args, "%14s", id) != 1) {
-        send_response(fd, "Usage: CANCEL <TrainID>");
+        send_response(c, "Usage: CANCEL <TrainID>");
         return;
     }
 
@@ -394,7 +828,7 @@ static void cmd_cancel(int fd, char *args) {
         if (strcmp(trains[i].id, id) == 0) {
             trains[i].delay = -999; //anulare
             strcpy(trains[i].eta, "--:--");
-            saveToXML();
+            request_save();
             found = 1;
             break;
         }
@@ -402,33 +836,34 @@ static void cmd_cancel(int fd, char *args) {
     pthread_mutex_unlock(&train_mutex);
 
     if (found) {
-        char msg[128];
-        snprintf(msg, sizeof(msg), "ALERT: Train %s has been CANCELLED due to technical issues.", id);
-        send_response(fd, msg);
+        board_changed();
+        OutBuf *b = out_begin();
+        ob_printf(b, "ALERT: Train %s has been CANCELLED due to technical issues.", id);
+        send_out(c, b);
     } else {
-        send_response(fd, "Train not found.");
+        send_response(c, "Train not found.");
     }
 }
 
-static void cmd_details(int fd, char *args) {
+static void cmd_details(Conn *c, char *args) {
     char id[15];
     if (sscanf(args, "%14s", id) != 1) {
-        send_response(fd, "Usage: DETAILS <TrainID>");
+        send_response(c, "Usage: DETAILS <TrainID>");
         return;
     }
 
+    OutBuf *b = out_begin();
     int found = 0;
     pthread_mutex_lock(&train_mutex);
     for (int i = 0; i < trainCount; i++) {
         if (strcmp(trains[i].id, id) == 0) {
-            char msg[512];
             char status[32];
             
             if (trains[i].delay == -999) strcpy(status, "CANCELLED");
             else if (trains[i].delay > 0) sprintf(status, "DELAYED (%d min)", trains[i].delay);
             else strcpy(status, "ON TIME");
 
-            snprintf(msg, sizeof(msg), 
+            ob_printf(b, 
                 "\n========================================\n"
                 "       TRAIN DETAILS: %s\n"
                 "========================================\n"
@@ -440,48 +875,50 @@ static void cmd_details(int fd, char *args) {
                 " Capacity:    180 Seats\n"
                 "========================================\n",
                 trains[i].id, status, trains[i].route, trains[i].features);
-            
-            send_response(fd, msg);
             found = 1;
             break;
         }
     }
     pthread_mutex_unlock(&train_mutex);
 
-    if (!found) send_response(fd, "Train not found.");
+    //trimitem abia dupa unlock: un client lent nu tine train_mutex ocupat
+    if (found) send_out(c, b);
+    else send_response(c, "Train not found.");
 }
 
-static void cmd_report(int fd, char *args) {
+static void cmd_report(Conn *c, char *args) {
     if (!args || strlen(args) < 5) {
-        send_response(fd, "Usage: REPORT <Message> (Please describe the issue)");
+        send_response(c, "Usage: REPORT <Message> (Please describe the issue)");
         return;
     }
 
     FILE *f = fopen("reports.log", "a");
     if (f) {
         time_t now = time(NULL);
-        char *t_str = ctime(&now);
+        char t_str[32];
+        ctime_r(&now, t_str);
         t_str[strlen(t_str)-1] = '\0'; 
 
-        fprintf(f, "[%s] Client FD %d reported: %s\n", t_str, fd, args);
+        fprintf(f, "[%s] Client FD %d reported: %s\n", t_str, c->fd, args);
         fclose(f);
         
-        printf("LOG: New report logged from Client %d.\n", fd);
-        send_response(fd, "Your report has been logged. Support team will investigate.");
+        printf("LOG: New report logged from Client %d.\n", c->fd);
+        send_response(c, "Your report has been logged. Support team will investigate.");
     } else {
-        send_response(fd, "Server Error: Could not save report.");
+        send_response(c, "Server Error: Could not save report.");
     }
 }
 
-static void cmd_estimate(int fd, char *args) {
+static void cmd_estimate(Conn *c, char *args) {
     char id[15];
     int km;
     
     if (sscanf(args, "%14s %d", id, &km) != 2) {
-        send_response(fd, "Usage: ESTIMATE <TrainID> <Distance_KM>");
+        send_response(c, "Usage: ESTIMATE <TrainID> <Distance_KM>");
         return;
     }
 
+    OutBuf *b = out_begin();
     int found = 0;
     pthread_mutex_lock(&train_mutex);
     for (int i = 0; i < trainCount; i++) {
@@ -490,8 +927,8 @@ static void cmd_estimate(int fd, char *args) {
             
             //verif daca e anulat
             if (trains[i].delay == -999) {
-                 send_response(fd, "OPERATION FAILED: Train is CANCELLED.\nNo estimation possible.");
                  pthread_mutex_unlock(&train_mutex);
+                 send_response(c, "OPERATION FAILED: Train is CANCELLED.\nNo estimation possible.");
                  return;
             }
             
@@ -504,8 +941,7 @@ static void cmd_estimate(int fd, char *args) {
             int delay_add = trains[i].delay;
             int final_eta = total_mins + delay_add;
 
-            char msg[512];
-            snprintf(msg, sizeof(msg),
+            ob_printf(b,
                 "\n--- TRIP ESTIMATOR: %s ---\n"
                 " Distance:      %d km\n"
                 " Avg Speed:     %d km/h\n"
@@ -517,100 +953,422 @@ static void cmd_estimate(int fd, char *args) {
                 total_mins/60, total_mins%60,
                 delay_add,
                 final_eta/60, final_eta%60);
-
-            send_response(fd, msg);
             break;
         }
     }
     pthread_mutex_unlock(&train_mutex);
 
-    if (!found) send_response(fd, "Train not found.");
+    if (found) send_out(c, b);
+    else send_response(c, "Train not found.");
 }
 
-typedef struct { const char *name; void (*handler)(int, char*); } CommandMap;
+//CRC-32 (IEEE 802.3), aceeasi valoare ca zlib crc32()
+static uint32_t crc_table[256];
+static pthread_once_t crc_once = PTHREAD_ONCE_INIT;
 
+static void crc_init(void) {
+    for (uint32_t i = 0; i < 256; i++) {
+        uint32_t c = i;
+        for (int k = 0; k < 8; k++) c = (c & 1) ? 0xEDB88320u ^ (c >> 1) : c >> 1;
+        crc_table[i] = c;
+    }
+}
+
+static uint32_t crc32_ieee(const char *data, size_t len) {
+    pthread_once(&crc_once, crc_init);
+
+    uint32_t c = 0xFFFFFFFFu;
+    for (size_t i = 0; i < len; i++) c = crc_table[(c ^ (uint8_t)data[i]) & 0xFF] ^ (c >> 8);
+    return c ^ 0xFFFFFFFFu;
+}
+
+/*
+ * Header datagrama (20 octeti, network byte order):
+ *   0  magic "TRNB"
+ *   4  u32 seq     - numarul panoului; creste la fiecare publicare
+ *   8  u16 frag    - indexul fragmentului
+ *  10  u16 nfrags  - numarul de fragmente al panoului
+ *  12  u16 len     - octeti de payload in aceasta datagrama
+ *  14  u16 rezervat
+ *  16  u32 crc     - CRC-32 al payload-ului
+ * Un receptor care vede o gaura in seq/frag cere panoul complet cu BOARD pe TCP.
+ */
+//-1 = eroare de socket (errno), -2 = panoul nu incape in BOARD_MAX_FRAGS fragmente
+static int publish_board(int sock, const char *data, size_t total, uint32_t seq) {
+    size_t nfrags = (total + BOARD_PAYLOAD - 1) / BOARD_PAYLOAD;
+    if (nfrags == 0) nfrags = 1;
+    if (nfrags > BOARD_MAX_FRAGS) return -2;
+
+    for (size_t f = 0; f < nfrags; f++) {
+        size_t off = f * BOARD_PAYLOAD;
+        size_t len = (total - off < BOARD_PAYLOAD) ? total - off : BOARD_PAYLOAD;
+        uint8_t hdr[BOARD_HDR_LEN];
+        uint32_t v32;
+        uint16_t v16;
+
+        memcpy(hdr, BOARD_MAGIC, 4);
+        v32 = htonl(seq);                   memcpy(hdr + 4, &v32, 4);
+        v16 = htons((uint16_t)f);           memcpy(hdr + 8, &v16, 2);
+        v16 = htons((uint16_t)nfrags);      memcpy(hdr + 10, &v16, 2);
+        v16 = htons((uint16_t)len);         memcpy(hdr + 12, &v16, 2);
+        v16 = 0;                            memcpy(hdr + 14, &v16, 2);
+        v32 = htonl(crc32_ieee(data + off, len));
+        memcpy(hdr + 16, &v32, 4);
+
+        struct iovec iov[2] = { { hdr, sizeof(hdr) }, { (void*)(data + off), len } };
+        struct msghdr msg = {
+            .msg_name = &board_addr, .msg_namelen = sizeof(board_addr),
+            .msg_iov = iov, .msg_iovlen = 2
+        };
+        if (sendmsg(sock, &msg, 0) < 0) return -1;
+    }
+    return 0;
+}
+
+//randeaza panoul o singura data si il pastreaza pentru BOARD; intoarce numarul panoului (0 = eroare)
+static uint32_t snapshot_board(OutBuf *b) {
+    render_departures(b);
+    render_arrivals(b);
+    if (b->failed) return 0;
+
+    uint32_t seq = 0;
+    pthread_mutex_lock(&board_mutex);
+    char *copy = realloc(board_snap, b->len);
+    if (copy) {
+        memcpy(copy, b->data, b->len);
+        board_snap = copy;
+        board_snap_len = b->len;
+        seq = ++board_seq;
+    }
+    pthread_mutex_unlock(&board_mutex);
+    return seq;
+}
+
+//-1 daca socket-ul nu poate fi creat
+static int board_socket(void) {
+    int sock = socket(AF_INET, SOCK_DGRAM, 0);
+    unsigned char ttl = 1, loop = 1;
+
+    if (sock < 0) return -1;
+
+    setsockopt(sock, IPPROTO_IP, IP_MULTICAST_TTL, &ttl, sizeof(ttl));
+    setsockopt(sock, IPPROTO_IP, IP_MULTICAST_LOOP, &loop, sizeof(loop));
+    if (board_if.s_addr != htonl(INADDR_ANY))
+        setsockopt(sock, IPPROTO_IP, IP_MULTICAST_IF, &board_if, sizeof(board_if));
+    return sock;
+}
+
+//publica la fiecare modificare si la fiecare minut (fereastra "next hour" se muta)
+//arg = socket-ul UDP deschis de board_socket()
+static void* board_publisher(void *arg) {
+    int sock = (int)(intptr_t)arg;
+    unsigned long seen = 0;
+    bool first = true;
+
+    while (1) {
+        pthread_mutex_lock(&board_mutex);
+        if (!first) {
+            struct timespec deadline;
+            clock_gettime(CLOCK_REALTIME, &deadline);
+            deadline.tv_sec = (deadline.tv_sec / 60 + 1) * 60;
+            deadline.tv_nsec = 0;
+
+            while (board_version == seen) {
+                if (pthread_cond_timedwait(&board_cond, &board_mutex, &deadline) == ETIMEDOUT) break;
+            }
+        }
+        seen = board_version;
+        first = false;
+        pthread_mutex_unlock(&board_mutex);
+
+        OutBuf *b = out_begin();
+        uint32_t seq = snapshot_board(b);
+        if (!seq) continue;
+        int rc = publish_board(sock, b->data, b->len, seq);
+        if (rc == -2)
+            fprintf(stderr, "board publish: board too large (%zu bytes, max %d fragments of %d)\n",
+                    b->len, BOARD_MAX_FRAGS, BOARD_PAYLOAD);
+        else if (rc < 0)
+            perror("board publish");
+    }
+    return NULL;
+}
+
+//recuperare pe TCP pentru panourile care au pierdut datagrame
+static void cmd_board(Conn *c, char *args) {
+    (void)args;
+    OutBuf *b = out_begin();
+
+    if (!board_enabled) {
+        ob_puts(b, "BOARD 0\n");
+        render_departures(b);
+        render_arrivals(b);
+    } else {
+        pthread_mutex_lock(&board_mutex);
+        ob_puts(b, "BOARD ");
+        ob_int(b, (long)board_seq);
+        ob_putc(b, '\n');
+        if (board_snap) ob_put(b, board_snap, board_snap_len);
+        pthread_mutex_unlock(&board_mutex);
+    }
+    send_out(c, b);
+}
+
+typedef struct { const char *name; void (*handler)(Conn*, char*); Lane lane; } CommandMap;
+
+//banda write e doar pentru comenzile care schimba starea trenurilor (nu sunt aruncate
+//niciodata); restul merg pe read, iar listele cu toata flota (SCHEDULE) pe bulk
 static CommandMap cmd_table[] = {
-    {"SCHEDULE",   cmd_schedule},
-    {"DEPARTURES", cmd_departures},
-    {"ARRIVALS",   cmd_arrivals},
-    {"UPDATE",     cmd_update},
-    {"RELOAD",     cmd_reload},
-    {"STATS",      cmd_stats},
-    {"RESET",      cmd_reset},
-    {"CANCEL",     cmd_cancel},
-    {"DETAILS",    cmd_details},
-    {"REPORT",     cmd_report},
-    {"ESTIMATE",   cmd_estimate}
+    {"SCHEDULE",   cmd_schedule,   LANE_BULK},
+    {"DEPARTURES", cmd_departures, LANE_READ},
+    {"ARRIVALS",   cmd_arrivals,   LANE_READ},
+    {"UPDATE",     cmd_update,     LANE_WRITE},
+    {"RELOAD",     cmd_reload,     LANE_WRITE},
+    {"STATS",      cmd_stats,      LANE_READ},
+    {"RESET",      cmd_reset,      LANE_WRITE},
+    {"CANCEL",     cmd_cancel,     LANE_WRITE},
+    {"DETAILS",    cmd_details,    LANE_READ},
+    {"REPORT",     cmd_report,     LANE_READ},
+    {"ESTIMATE",   cmd_estimate,   LANE_READ},
+    {"BOARD",      cmd_board,      LANE_READ}
 };
 
+static int find_command(const char *command) {
+    size_t ncmd = sizeof(cmd_table) / sizeof(cmd_table[0]);
+
+    for (size_t i = 0; i < ncmd; i++) {
+        if (strncmp(command, cmd_table[i].name, strlen(cmd_table[i].name)) == 0)
+            return (int)i;
+    }
+    return -1;
+}
+
+//prima banda (in ordinea prioritatii) cu cereri si cu workeri disponibili; apelat cu queue_mutex luat
+static int pick_lane(void) {
+    for (int l = 0; l < LANE_COUNT; l++) {
+        if (lanes[l].count > 0 && lanes[l].active < lanes[l].workers) return l;
+    }
+    return -1;
+}
+
 static void* worker_thread(void *arg) {
     (void)arg;
     while (1) {
         Request req;
+        int l;
 
         pthread_mutex_lock(&queue_mutex);
-        while (qcount == 0) pthread_cond_wait(&queue_cond, &queue_mutex);
-        req = queue[head];
-        head = (head + 1) % QUEUE_SIZE;
-        qcount--;
+        while ((l = pick_lane()) < 0) pthread_cond_wait(&queue_cond, &queue_mutex);
+        LaneQueue *q = &lanes[l];
+        req = q->items[q->head];
+        q->head = (q->head + 1) % QUEUE_SIZE;
+        q->count--;
+        q->active++;
+
+        bool late = q->target_ms > 0 && mono_ms() - req.enq_ms > q->target_ms;
+        if (late) q->shed++;
         pthread_mutex_unlock(&queue_mutex);
 
-        int executed = 0;
-        size_t ncmd = sizeof(cmd_table) / sizeof(cmd_table[0]);
-
-        for (size_t i = 0; i < ncmd; i++) {
-            if (strncmp(req.command, cmd_table[i].name, strlen(cmd_table[i].name)) == 0) {
-                cmd_table[i].handler(req.client_fd, req.command + strlen(cmd_table[i].name));
-                executed = 1;
-                break;
-            }
+        //cererile unui client care a plecat nu se mai executa
+        reply_tag = req.tag;
+        if (!conn_closed(req.conn)) {
+            if (late) send_response(req.conn, busy_msg);
+            else if (req.cmd < 0) send_response(req.conn, "Unknown command.");
+            else cmd_table[req.cmd].handler(req.conn, req.command + strlen(cmd_table[req.cmd].name));
         }
-        if (!executed) send_response(req.client_fd, "Unknown command.");
+        reply_tag = "";
+        conn_put(req.conn);
+
+        //banda poate avea cereri care asteptau doar dupa bugetul de workeri
+        pthread_mutex_lock(&queue_mutex);
+        q->active--;
+        if (q->count > 0) pthread_cond_signal(&queue_cond);
+        pthread_mutex_unlock(&queue_mutex);
     }
     return NULL;
 }
 
+//returneaza -1 daca banda comenzii e plina
+static int enqueue_request(Conn *c, const char *tag, const char *command) {
+    int cmd = find_command(command);
+    LaneQueue *q = &lanes[cmd < 0 ? LANE_READ : cmd_table[cmd].lane];
+    int ok = 0;
+
+    pthread_mutex_lock(&queue_mutex);
+    if (q->count < q->limit) {
+        Request *r = &q->items[q->tail];
+        size_t len = strnlen(command, sizeof(r->command) - 1);
+
+        conn_get(c);
+        r->conn = c;
+        r->cmd = cmd;
+        r->enq_ms = mono_ms();
+        snprintf(r->tag, sizeof(r->tag), "%s", tag);
+        memcpy(r->command, command, len);
+        r->command[len] = 0;
+        q->tail = (q->tail + 1) % QUEUE_SIZE;
+        q->count++;
+        pthread_cond_signal(&queue_cond);
+        ok = 1;
+    } else if (q != &lanes[LANE_WRITE]) {
+        q->shed++;      //o scriere refuzata e reincercata de client_handler, nu aruncata
+    }
+    pthread_mutex_unlock(&queue_mutex);
+
+    return ok ? 0 : -1;
+}
+
+//"@<tag> COMANDA" -> tag-ul (trunchiat la TAG_LEN - 1) si restul liniei
+static char* split_tag(char *line, char *tag) {
+    tag[0] = 0;
+    if (line[0] != '@') return line;
+
+    char *p = line + 1;
+    size_t n = strcspn(p, " ");
+    size_t keep = (n < TAG_LEN - 1) ? n : TAG_LEN - 1;
+    memcpy(tag, p, keep);
+    tag[keep] = 0;
+
+    p += n;
+    while (*p == ' ') p++;
+    return p;
+}
+
+//o scriere care nu incape pe banda write nu primeste "busy": conexiunea ei nu mai e
+//citita pana se elibereaza un loc (verificat la fiecare WRITE_RETRY_MS)
+static bool is_write(const char *command) {
+    int cmd = find_command(command);
+    return cmd >= 0 && cmd_table[cmd].lane == LANE_WRITE;
+}
+
 static void* client_handler(void *arg) {
-    int fd = *(int*)arg;
-    free(arg);
+    Conn *c = arg;
 
     char stream_buf[1024];
     int pos = 0;
+    char r[512];
+    int rlen = 0, rpos = 0;     //octeti primiti, inca neprocesati
+    char tag[TAG_LEN];
+    char *held = NULL;          //scriere care asteapta loc pe banda (in stream_buf)
+    struct pollfd pfd[2] = { { c->fd, POLLIN, 0 }, { c->wake_fd, POLLIN, 0 } };
+
+    //singurul loc in care thread-ul asteapta e poll(): citim cereri si golim
+    //coada de iesire a conexiunii, fara sa blocam in recv/send
+    while (!conn_closed(c)) {
+        if (held && enqueue_request(c, tag, held) == 0) {
+            held = NULL;
+            pos = 0;
+        }
 
-    while (1) {
-        char r[512];
-        ssize_t n = recv(fd, r, sizeof(r), 0);
-        if (n <= 0) break;
-
-        for (int i = 0; i < n; i++) {
-            if (r[i] == '\n' || r[i] == '\r') {
+        while (!held && rpos < rlen) {
+            char ch = r[rpos++];
+            if (ch == '\n' || ch == '\r') {
                 if (pos > 0) {
                     stream_buf[pos] = 0;
-
-                    pthread_mutex_lock(&queue_mutex);
-                    if (qcount < QUEUE_SIZE) {
-                        queue[tail].client_fd = fd;
-                        strncpy(queue[tail].command, stream_buf, 255);
-                        queue[tail].command[255] = 0;
-                        tail = (tail + 1) % QUEUE_SIZE;
-                        qcount++;
-                        pthread_cond_signal(&queue_cond);
+                    char *command = split_tag(stream_buf, tag);
+
+                    if (enqueue_request(c, tag, command) == 0) {
+                        pos = 0;
+                    } else if (is_write(command)) {
+                        held = command;
+                    } else {
+                        reply_tag = tag;
+                        send_response(c, busy_msg);
+                        reply_tag = "";
+                        pos = 0;
                     }
-                    pthread_mutex_unlock(&queue_mutex);
-
-                    pos = 0;
                 }
             } else if (pos < (int)sizeof(stream_buf) - 1) {
-                stream_buf[pos++] = r[i];
+                stream_buf[pos++] = ch;
+            }
+        }
+
+        pthread_mutex_lock(&c->send_lock);
+        size_t pending = c->out_len - c->out_off;
+        long long idle = 0;
+        if (pending) {
+            //si kernelul poate tine megabytes: daca bufferul socket-ului scade, clientul inca citeste
+            int unsent;
+            if (ioctl(c->fd, SIOCOUTQ, &unsent) == 0 && unsent != c->out_kernel) {
+                c->out_kernel = unsent;
+                c->out_progress_ms = mono_ms();
+            }
+            idle = mono_ms() - c->out_progress_ms;
+        }
+        pthread_mutex_unlock(&c->send_lock);
+
+        //un client care nu mai citeste deloc e deconectat; unul doar lent e franat:
+        //peste CONN_OUT_HIGH nu mai citim cereri noi pana nu isi ia raspunsurile
+        if (idle > CONN_STALL_MS) {
+            conn_drop(c);
+            break;
+        }
+        bool want_input = !held && pending < CONN_OUT_HIGH;
+        int timeout = held ? WRITE_RETRY_MS : pending ? 1000 : -1;
+        pfd[0].events = (want_input ? POLLIN : 0) | (pending ? POLLOUT : 0);
+        if (poll(pfd, 2, timeout) < 0) {
+            if (errno == EINTR) continue;
+            break;
+        }
+
+        if (pfd[1].revents & POLLIN) {
+            uint64_t v;
+            if (read(c->wake_fd, &v, sizeof(v)) < 0) { /* nimic de golit */ }
+        }
+
+        if (pfd[0].revents & (POLLOUT | POLLERR | POLLHUP)) {
+            pthread_mutex_lock(&c->send_lock);
+            int rc = conn_flush(c);
+            pthread_mutex_unlock(&c->send_lock);
+            if (rc < 0) {
+                conn_drop(c);
+                break;
             }
         }
+
+        if (!want_input || !(pfd[0].revents & (POLLIN | POLLERR | POLLHUP))) continue;
+
+        ssize_t n = recv(c->fd, r, sizeof(r), MSG_DONTWAIT);
+        if (n < 0 && (errno == EAGAIN || errno == EWOULDBLOCK || errno == EINTR)) continue;
+        if (n <= 0) break;
+        rlen = (int)n;
+        rpos = 0;
     }
 
-    close(fd);
+    conn_shutdown(c);
+    conn_put(c);
     return NULL;
 }
 
-int main(void) {
+//bench/bench_server.c include-uieste acest fisier fara main()
+#ifndef TRAIN_SERVER_NO_MAIN
+static void usage(const char *argv0) {
+    fprintf(stderr, "Usage: %s [-m <group>:<port> [-i <interface addr>]]\n", argv0);
+    exit(2);
+}
+
+int main(int argc, char **argv) {
+    board_if.s_addr = htonl(INADDR_ANY);
+
+    //-m porneste panoul multicast, -i alege interfata (ex. 127.0.0.1 pentru teste pe loopback)
+    for (int i = 1; i < argc; i++) {
+        if (strcmp(argv[i], "-m") == 0 && i + 1 < argc) {
+            char group[64];
+            int port, end = 0;
+            const char *spec = argv[++i];
+            if (sscanf(spec, "%63[^:]:%d%n", group, &port, &end) != 2 || spec[end] != '\0' ||
+                port < 1 || port > 65535 ||
+                inet_pton(AF_INET, group, &board_addr.sin_addr) != 1) usage(argv[0]);
+            board_addr.sin_family = AF_INET;
+            board_addr.sin_port = htons(port);
+            board_enabled = true;
+        } else if (strcmp(argv[i], "-i") == 0 && i + 1 < argc) {
+            if (inet_pton(AF_INET, argv[++i], &board_if) != 1) usage(argv[0]);
+        } else {
+            usage(argv[0]);
+        }
+    }
+
     signal(SIGPIPE, SIG_IGN);
     signal(SIGUSR1, handle_sigusr1);
 
@@ -620,6 +1378,23 @@ int main(void) {
     for (int i = 0; i < WORKER_THREADS; i++)
         pthread_create(&w[i], NULL, worker_thread, NULL);
 
+    pthread_t sv;
+    pthread_create(&sv, NULL, saver_thread, NULL);
+    pthread_detach(sv);
+
+    if (board_enabled) {
+        int bsock = board_socket();
+        if (bsock < 0) {
+            perror("board socket");
+            return 1;
+        }
+        pthread_t bp;
+        pthread_create(&bp, NULL, board_publisher, (void*)(intptr_t)bsock);
+        pthread_detach(bp);
+        printf("Publishing departures board to %s:%d\n",
+               inet_ntoa(board_addr.sin_addr), ntohs(board_addr.sin_port));
+    }
+
     int sfd = socket(AF_INET, SOCK_STREAM, 0);
     struct sockaddr_in addr = {
         .sin_family = AF_INET,
@@ -638,6 +1413,7 @@ int main(void) {
     while (1) {
         if (reload_flag) {
             printf("Reloading XML...\n");
+            flush_saves();
             loadXML();
             reload_flag = 0;
         }
@@ -649,14 +1425,16 @@ int main(void) {
 
         if (select(sfd + 1, &fds, NULL, NULL, &tv) > 0) {
             int cfd = accept(sfd, NULL, NULL);
-            int *p = malloc(sizeof(int));
-            *p = cfd;
+            if (cfd < 0) continue;
+            Conn *c = conn_new(cfd);
+            if (!c) { close(cfd); continue; }
 
             pthread_t t;
-            pthread_create(&t, NULL, client_handler, p);
+            pthread_create(&t, NULL, client_handler, c);
             pthread_detach(t);
         }
     }
 
     return 0;
-}
\ No newline at end of file
+}
+#endif
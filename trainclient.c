@@ -0,0 +1,537 @@
+#define _GNU_SOURCE
+#include "trainclient.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdint.h>
+#include <stdbool.h>
+#include <unistd.h>
+#include <fcntl.h>
+#include <poll.h>
+#include <errno.h>
+#include <time.h>
+#include <netdb.h>
+#include <arpa/inet.h>
+#include <netinet/tcp.h>
+#include <sys/socket.h>
+#include <sys/random.h>
+
+#define MSG_END "\n==END==\n"
+#define MSG_END_LEN (sizeof(MSG_END) - 1)
+#define BUSY_MSG "Server busy. Please retry."
+#define RECONNECT_MIN_MS 100
+#define RECONNECT_MAX_MS 5000
+
+typedef struct {
+    char  *data;
+    size_t off, len, cap;
+} Buf;
+
+typedef struct {
+    uint32_t    tag;
+    tc_callback cb;
+    void       *user;
+} Pending;
+
+//un raspuns gata de livrat; body e un offset in bufferul detasat din conn_read
+typedef struct {
+    Pending p;
+    int status;
+    size_t body, len;
+} Completion;
+
+struct tc_conn {
+    int fd;
+    bool dead;
+    int depth;          //callback-uri in executie pe aceasta conexiune
+    bool closing;       //tc_close() apelat dintr-un callback; eliberam la iesire
+    uint32_t next_tag;
+
+    Buf out;            //octeti de trimis (doar cereri din fereastra)
+    Buf backlog;        //cereri care asteapta loc in fereastra
+    Buf in;             //raspunsuri primite, inca neprocesate
+    size_t scan;        //de unde cautam urmatorul MSG_END in `in`
+    size_t on_wire;     //cereri trimise catre server, fara raspuns
+
+    Pending *pend;      //toate cererile neterminate (in fereastra + backlog)
+    size_t npend, cap_pend;
+
+    //adresa serverului, pentru reconectarea din pool
+    struct sockaddr_storage addr;
+    socklen_t addrlen;
+    long long retry_at;     //cand poate fi reincercata o conexiune moarta
+    int backoff_ms;         //0 dupa un raspuns reusit; se dubleaza la fiecare esec
+};
+
+struct tc_pool {
+    tc_conn **conns;
+    int n;
+};
+
+struct tc_future {
+    tc_conn *conn;
+    tc_pool *pool;
+    bool done, orphan;
+    int status;
+    char *reply;
+    size_t len;
+};
+
+static bool buf_append(Buf *b, const char *s, size_t n) {
+    if (b->len + n > b->cap) {
+        //mutam datele consumate inapoi la inceput inainte sa crestem bufferul
+        if (b->off > 0) {
+            memmove(b->data, b->data + b->off, b->len - b->off);
+            b->len -= b->off;
+            b->off = 0;
+        }
+        if (b->len + n > b->cap) {
+            size_t cap = b->cap ? b->cap : 4096;
+            while (b->len + n > cap) cap *= 2;
+            char *d = realloc(b->data, cap);
+            if (!d) return false;
+            b->data = d;
+            b->cap = cap;
+        }
+    }
+    memcpy(b->data + b->len, s, n);
+    b->len += n;
+    return true;
+}
+
+static void buf_consume(Buf *b, size_t n) {
+    b->off += n;
+    if (b->off == b->len) b->off = b->len = 0;
+}
+
+static void buf_free(Buf *b) {
+    free(b->data);
+    memset(b, 0, sizeof(*b));
+}
+
+static long long now_ms(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (long long)ts.tv_sec * 1000 + ts.tv_nsec / 1000000;
+}
+
+//toate cererile ramase primesc TC_EDISCONNECT
+static void conn_fail(tc_conn *c) {
+    c->dead = true;
+    c->retry_at = now_ms() + c->backoff_ms;
+    c->on_wire = 0;
+    buf_free(&c->out);
+    buf_free(&c->backlog);
+
+    c->depth++;
+    while (c->npend > 0) {
+        Pending p = c->pend[--c->npend];
+        if (p.cb) p.cb(p.user, TC_EDISCONNECT, "", 0);
+    }
+    c->depth--;
+}
+
+static void conn_destroy(tc_conn *c) {
+    conn_fail(c);
+    close(c->fd);
+    buf_free(&c->in);
+    free(c->pend);
+    free(c);
+}
+
+//dupa un apel public: o conexiune inchisa din callback e eliberata abia acum; true = eliberata
+static bool conn_settle(tc_conn *c) {
+    if (!c->closing || c->depth > 0) return false;
+    conn_destroy(c);
+    return true;
+}
+
+static int conn_flush(tc_conn *c) {
+    while (c->out.off < c->out.len) {
+        ssize_t n = send(c->fd, c->out.data + c->out.off, c->out.len - c->out.off,
+                         MSG_NOSIGNAL | MSG_DONTWAIT);
+        if (n < 0 && errno == EINTR) continue;
+        if (n < 0 && (errno == EAGAIN || errno == EWOULDBLOCK)) return 0;
+        if (n <= 0) return -1;
+        buf_consume(&c->out, (size_t)n);
+    }
+    return 0;
+}
+
+//muta cereri din backlog in fereastra cat timp e loc
+static void conn_fill_window(tc_conn *c) {
+    while (c->on_wire < TC_WINDOW && c->backlog.off < c->backlog.len) {
+        const char *line = c->backlog.data + c->backlog.off;
+        const char *nl = memchr(line, '\n', c->backlog.len - c->backlog.off);
+        size_t n = (size_t)(nl - line) + 1;
+
+        if (!buf_append(&c->out, line, n)) return;
+        buf_consume(&c->backlog, n);
+        c->on_wire++;
+    }
+}
+
+//scoate cererea cu acest tag din cele neterminate
+static bool conn_take(tc_conn *c, uint32_t tag, Pending *out) {
+    for (size_t i = 0; i < c->npend; i++) {
+        if (c->pend[i].tag != tag) continue;
+
+        *out = c->pend[i];
+        c->pend[i] = c->pend[--c->npend];
+        c->on_wire--;
+        c->backoff_ms = 0;
+        conn_fill_window(c);
+        return true;
+    }
+    return false;
+}
+
+//citeste tot ce e disponibil si proceseaza raspunsurile complete. Callback-urile
+//ruleaza abia dupa ce toate cadrele au fost separate si bufferul lor a fost detasat
+//de conexiune, asa ca un callback poate apela tc_poll()/tc_close() pe ea.
+static int conn_read(tc_conn *c) {
+    Completion *done_list = NULL;
+    size_t ndone = 0, cap_done = 0;
+    bool eof = false;
+
+    while (1) {
+        char tmp[65536];
+        ssize_t n = recv(c->fd, tmp, sizeof(tmp), MSG_DONTWAIT);
+        if (n < 0 && errno == EINTR) continue;
+        if (n < 0 && (errno == EAGAIN || errno == EWOULDBLOCK)) break;
+        if (n <= 0 || !buf_append(&c->in, tmp, (size_t)n)) { eof = true; break; }
+    }
+
+    while (1) {
+        char *start = c->in.data + c->in.off;
+        size_t avail = c->in.len - c->in.off;
+        if (c->scan > avail) c->scan = 0;
+
+        char *end = memmem(start + c->scan, avail - c->scan, MSG_END, MSG_END_LEN);
+        if (!end) {
+            c->scan = (avail >= MSG_END_LEN) ? avail - MSG_END_LEN + 1 : 0;
+            break;
+        }
+
+        size_t frame = (size_t)(end - start);
+        *end = 0;   //raspunsul devine sir C pentru callback
+
+        //loc rezervat inainte de conn_take, ca o cerere scoasa sa fie mereu livrata
+        if (ndone == cap_done) {
+            size_t cap = cap_done ? cap_done * 2 : 16;
+            Completion *d = realloc(done_list, cap * sizeof(Completion));
+            if (!d) { eof = true; break; }
+            done_list = d;
+            cap_done = cap;
+        }
+
+        Pending p;
+        if (start[0] == '@') {
+            char *e;
+            uint32_t tag = (uint32_t)strtoul(start + 1, &e, 10);
+            if (*e == '\n' && conn_take(c, tag, &p)) {
+                e++;
+                size_t len = frame - (size_t)(e - start);
+                int status = (len == sizeof(BUSY_MSG) - 1 && memcmp(e, BUSY_MSG, len) == 0) ? TC_BUSY : TC_OK;
+                done_list[ndone++] = (Completion){ p, status, (size_t)(e - c->in.data), len };
+            }
+        }
+        //raspunsurile fara tag nu ne apartin; le ignoram
+
+        buf_consume(&c->in, frame + MSG_END_LEN);
+        c->scan = 0;
+    }
+
+    if (ndone > 0) {
+        //cadrele raman in `frames`; conexiunea pastreaza doar restul incomplet
+        Buf frames = c->in;
+        memset(&c->in, 0, sizeof(c->in));
+        if (frames.off < frames.len && !buf_append(&c->in, frames.data + frames.off, frames.len - frames.off))
+            eof = true;
+
+        c->depth++;
+        for (size_t i = 0; i < ndone; i++) {
+            Completion *d = &done_list[i];
+            if (d->p.cb) d->p.cb(d->p.user, d->status, frames.data + d->body, d->len);
+        }
+        c->depth--;
+        buf_free(&frames);
+    }
+    free(done_list);
+    return eof ? -1 : (int)ndone;
+}
+
+static int conn_pump(tc_conn *c, short revents) {
+    int done = 0;
+
+    if (revents & (POLLIN | POLLHUP | POLLERR)) {
+        done = conn_read(c);
+        if (done < 0) { conn_fail(c); return -1; }
+    }
+    if (conn_flush(c) < 0) { conn_fail(c); return -1; }
+    return done;
+}
+
+//tag-uri aleatoare per conexiune: un raspuns ratacit nu nimereste o cerere noua
+static uint32_t first_tag(void) {
+    uint32_t t = 0;
+    if (getrandom(&t, sizeof(t), 0) != (ssize_t)sizeof(t)) {
+        struct timespec ts;
+        clock_gettime(CLOCK_MONOTONIC, &ts);
+        t = (uint32_t)ts.tv_nsec ^ ((uint32_t)getpid() << 16);
+    }
+    return t ? t : 1;
+}
+
+static int open_socket(const struct sockaddr *addr, socklen_t len) {
+    int fd = socket(AF_INET, SOCK_STREAM, 0);
+    if (fd < 0 || connect(fd, addr, len) < 0) {
+        if (fd >= 0) close(fd);
+        return -1;
+    }
+
+    int one = 1;
+    setsockopt(fd, IPPROTO_TCP, TCP_NODELAY, &one, sizeof(one));
+    fcntl(fd, F_SETFL, fcntl(fd, F_GETFL) | O_NONBLOCK);
+    return fd;
+}
+
+//redeschide o conexiune moarta pe loc (pointerul ramane valid), cu backoff exponential
+static bool conn_revive(tc_conn *c) {
+    if (!c->dead) return true;
+    if (now_ms() < c->retry_at) return false;
+
+    //urmatoarea asteptare, daca nici aceasta conexiune nu aduce vreun raspuns
+    c->backoff_ms = c->backoff_ms ? c->backoff_ms * 2 : RECONNECT_MIN_MS;
+    if (c->backoff_ms > RECONNECT_MAX_MS) c->backoff_ms = RECONNECT_MAX_MS;
+
+    int fd = open_socket((struct sockaddr*)&c->addr, c->addrlen);
+    if (fd < 0) {
+        c->retry_at = now_ms() + c->backoff_ms;
+        return false;
+    }
+
+    close(c->fd);
+    c->fd = fd;
+    c->dead = false;
+    buf_free(&c->in);
+    c->scan = 0;
+    return true;
+}
+
+tc_conn* tc_connect(const char *host, int port) {
+    struct addrinfo hints = { .ai_family = AF_INET, .ai_socktype = SOCK_STREAM }, *res;
+    char service[16];
+
+    snprintf(service, sizeof(service), "%d", port);
+    if (getaddrinfo(host, service, &hints, &res) != 0) return NULL;
+
+    int fd = open_socket(res->ai_addr, res->ai_addrlen);
+    tc_conn *c = (fd >= 0) ? calloc(1, sizeof(*c)) : NULL;
+    if (!c) {
+        if (fd >= 0) close(fd);
+        freeaddrinfo(res);
+        return NULL;
+    }
+    memcpy(&c->addr, res->ai_addr, res->ai_addrlen);
+    c->addrlen = res->ai_addrlen;
+    freeaddrinfo(res);
+
+    c->fd = fd;
+    c->next_tag = first_tag();
+    return c;
+}
+
+void tc_close(tc_conn *c) {
+    if (!c) return;
+    if (c->depth > 0) {
+        //apelat dintr-un callback al acestei conexiuni: conn_read inca o foloseste
+        c->closing = true;
+        conn_fail(c);
+        return;
+    }
+    conn_destroy(c);
+}
+
+int tc_fd(const tc_conn *c) { return c->fd; }
+
+size_t tc_inflight(const tc_conn *c) { return c->npend; }
+
+int tc_submit(tc_conn *c, const char *command, tc_callback cb, void *user) {
+    size_t len = strlen(command);
+    if (c->dead || len == 0 || len > TC_MAX_COMMAND || strpbrk(command, "\r\n")) return -1;
+
+    if (c->npend == c->cap_pend) {
+        size_t cap = c->cap_pend ? c->cap_pend * 2 : 64;
+        Pending *p = realloc(c->pend, cap * sizeof(Pending));
+        if (!p) return -1;
+        c->pend = p;
+        c->cap_pend = cap;
+    }
+
+    char line[TC_MAX_COMMAND + 16];
+    uint32_t tag = c->next_tag++;
+    if (c->next_tag == 0) c->next_tag = 1;
+    int n = snprintf(line, sizeof(line), "@%u %s\n", tag, command);
+
+    Buf *dst = (c->on_wire < TC_WINDOW) ? &c->out : &c->backlog;
+    if (!buf_append(dst, line, (size_t)n)) return -1;
+    if (dst == &c->out) c->on_wire++;
+
+    c->pend[c->npend++] = (Pending){ tag, cb, user };
+
+    //cererea e acceptata: daca trimiterea esueaza, callback-ul ei primeste TC_EDISCONNECT
+    if (conn_flush(c) < 0) {
+        conn_fail(c);
+        conn_settle(c);
+    }
+    return 0;
+}
+
+int tc_poll(tc_conn *c, int timeout_ms) {
+    if (c->dead) return -1;
+
+    struct pollfd pfd = { .fd = c->fd, .events = POLLIN };
+    if (c->out.off < c->out.len) pfd.events |= POLLOUT;
+
+    int r = poll(&pfd, 1, timeout_ms);
+    if (r < 0) return (errno == EINTR) ? 0 : -1;
+    if (r == 0) return 0;
+    r = conn_pump(c, pfd.revents);
+    if (conn_settle(c)) return -1;
+    return r;
+}
+
+tc_pool* tc_pool_create(const char *host, int port, int nconns) {
+    tc_pool *p = calloc(1, sizeof(*p));
+    if (!p || nconns <= 0) { free(p); return NULL; }
+
+    p->conns = calloc((size_t)nconns, sizeof(tc_conn*));
+    if (!p->conns) { free(p); return NULL; }
+
+    for (int i = 0; i < nconns; i++) {
+        p->conns[i] = tc_connect(host, port);
+        if (!p->conns[i]) { tc_pool_destroy(p); return NULL; }
+        p->n++;
+    }
+    return p;
+}
+
+void tc_pool_destroy(tc_pool *p) {
+    if (!p) return;
+    for (int i = 0; i < p->n; i++) tc_close(p->conns[i]);
+    free(p->conns);
+    free(p);
+}
+
+size_t tc_pool_inflight(const tc_pool *p) {
+    size_t total = 0;
+    for (int i = 0; i < p->n; i++) total += p->conns[i]->npend;
+    return total;
+}
+
+//conexiunea vie cu cele mai putine cereri neterminate; cele moarte sunt reincercate
+static tc_conn* pool_pick(tc_pool *p) {
+    tc_conn *best = NULL;
+    for (int i = 0; i < p->n; i++) {
+        tc_conn *c = p->conns[i];
+        if (conn_revive(c) && (!best || c->npend < best->npend)) best = c;
+    }
+    return best;
+}
+
+int tc_pool_submit(tc_pool *p, const char *command, tc_callback cb, void *user) {
+    tc_conn *c = pool_pick(p);
+    return c ? tc_submit(c, command, cb, user) : -1;
+}
+
+int tc_pool_poll(tc_pool *p, int timeout_ms) {
+    struct pollfd pfd[p->n];
+    int alive = 0;
+
+    for (int i = 0; i < p->n; i++) {
+        tc_conn *c = p->conns[i];
+        conn_revive(c);
+        pfd[i].fd = c->dead ? -1 : c->fd;
+        pfd[i].events = POLLIN;
+        pfd[i].revents = 0;
+        if (c->out.off < c->out.len) pfd[i].events |= POLLOUT;
+        if (!c->dead) alive++;
+    }
+    if (!alive) return -1;
+
+    int r = poll(pfd, (nfds_t)p->n, timeout_ms);
+    if (r < 0) return (errno == EINTR) ? 0 : -1;
+
+    int done = 0;
+    for (int i = 0; i < p->n && r > 0; i++) {
+        if (!pfd[i].revents) continue;
+        int d = conn_pump(p->conns[i], pfd[i].revents);
+        if (d > 0) done += d;
+    }
+    return done;
+}
+
+static void future_cb(void *user, int status, const char *reply, size_t len) {
+    tc_future *f = user;
+
+    if (f->orphan) { free(f); return; }
+    f->reply = malloc(len + 1);
+    if (f->reply) {
+        memcpy(f->reply, reply, len);
+        f->reply[len] = 0;
+        f->len = len;
+    }
+    f->status = status;
+    f->done = true;
+}
+
+tc_future* tc_submit_future(tc_conn *c, const char *command) {
+    tc_future *f = calloc(1, sizeof(*f));
+    if (!f) return NULL;
+    f->conn = c;
+    if (tc_submit(c, command, future_cb, f) < 0) { free(f); return NULL; }
+    return f;
+}
+
+tc_future* tc_pool_submit_future(tc_pool *p, const char *command) {
+    tc_future *f = calloc(1, sizeof(*f));
+    if (!f) return NULL;
+    f->pool = p;
+    if (tc_pool_submit(p, command, future_cb, f) < 0) { free(f); return NULL; }
+    return f;
+}
+
+int tc_future_wait(tc_future *f, int timeout_ms) {
+    long long deadline = now_ms() + timeout_ms;
+
+    while (!f->done) {
+        int left = -1;
+        if (timeout_ms >= 0) {
+            long long ms = deadline - now_ms();
+            if (ms <= 0) return -1;
+            left = (int)ms;
+        }
+        int r = f->pool ? tc_pool_poll(f->pool, left) : tc_poll(f->conn, left);
+        if (r < 0 && !f->done) return -1;
+    }
+    return 0;
+}
+
+int tc_future_done(const tc_future *f) { return f->done; }
+
+int tc_future_status(const tc_future *f) { return f->status; }
+
+const char* tc_future_reply(const tc_future *f, size_t *len) {
+    if (len) *len = f->len;
+    return f->reply ? f->reply : "";
+}
+
+//un future nefinalizat e eliberat de callback cand soseste raspunsul
+void tc_future_free(tc_future *f) {
+    if (!f) return;
+    if (!f->done) { f->orphan = true; return; }
+    free(f->reply);
+    free(f);
+}
@@ -0,0 +1,67 @@
+#ifndef TRAINCLIENT_H
+#define TRAINCLIENT_H
+
+#include <stddef.h>
+
+/*
+ * libtrainclient - client pipelined pentru serverul de trenuri.
+ *
+ * Fiecare cerere pleaca sub forma "@<tag> COMANDA\n", iar serverul intoarce
+ * "@<tag>\n<raspuns>\n==END==\n", asa ca pe aceeasi conexiune pot fi oricate
+ * cereri in zbor si raspunsurile pot veni in orice ordine.
+ *
+ * Biblioteca nu porneste thread-uri: apelantul "pompeaza" I/O cu tc_poll() /
+ * tc_pool_poll() (sau asteapta un future), iar callback-urile ruleaza in acel
+ * apel. O conexiune sau un pool se folosesc dintr-un singur thread.
+ *
+ * Un callback poate trimite cereri noi, poate apela tc_poll()/tc_future_wait()
+ * si tc_close() pe propria conexiune (inchiderea se termina la iesirea din
+ * apelul exterior). tc_pool_destroy() nu se apeleaza dintr-un callback.
+ */
+
+#define TC_DEFAULT_PORT 8080
+#define TC_WINDOW 64           //cereri trimise si neconfirmate per conexiune
+#define TC_MAX_COMMAND 200
+
+enum {
+    TC_OK = 0,                 //raspuns normal
+    TC_BUSY = 1,               //serverul a refuzat cererea (suprasarcina); se poate reincerca
+    TC_EDISCONNECT = -1        //conexiunea s-a inchis inainte de raspuns
+};
+
+typedef struct tc_conn tc_conn;
+typedef struct tc_pool tc_pool;
+typedef struct tc_future tc_future;
+
+//reply nu e NUL-terminat obligatoriu peste len; e valid doar pe durata apelului
+typedef void (*tc_callback)(void *user, int status, const char *reply, size_t len);
+
+tc_conn* tc_connect(const char *host, int port);
+void     tc_close(tc_conn *c);
+int      tc_fd(const tc_conn *c);
+size_t   tc_inflight(const tc_conn *c);
+
+//pune cererea in coada conexiunii; -1 daca comanda e invalida sau conexiunea e moarta
+int      tc_submit(tc_conn *c, const char *command, tc_callback cb, void *user);
+//trimite/primeste cat se poate in cel mult timeout_ms (-1 = blocant); intoarce nr. de raspunsuri sau -1
+int      tc_poll(tc_conn *c, int timeout_ms);
+
+//conexiunile moarte ale pool-ului sunt redeschise la tc_pool_submit()/tc_pool_poll(),
+//cu asteptare exponentiala intre incercari (100 ms .. 5 s); tc_pool_poll() intoarce -1
+//doar cand nicio conexiune nu e vie in acel moment
+tc_pool* tc_pool_create(const char *host, int port, int nconns);
+void     tc_pool_destroy(tc_pool *p);
+size_t   tc_pool_inflight(const tc_pool *p);
+int      tc_pool_submit(tc_pool *p, const char *command, tc_callback cb, void *user);
+int      tc_pool_poll(tc_pool *p, int timeout_ms);
+
+//variante future: rezultatul se citeste dupa tc_future_wait()
+tc_future*  tc_submit_future(tc_conn *c, const char *command);
+tc_future*  tc_pool_submit_future(tc_pool *p, const char *command);
+int         tc_future_wait(tc_future *f, int timeout_ms);   //0 = gata, -1 = timeout
+int         tc_future_done(const tc_future *f);
+int         tc_future_status(const tc_future *f);
+const char* tc_future_reply(const tc_future *f, size_t *len);
+void        tc_future_free(tc_future *f);
+
+#endif